@@ -12,34 +12,221 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <list>
-#include <unordered_map>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
 
 /*Buffer pool holds the pages in the main memory.
 Page table is used to manage pages currently in buffer pool.
 Frames are the location of pages and pages are what actually stores the content
-Pages are in a continuous array which can be indexed via frame id.*/
+Pages are in a continuous array which is split into shards. Inside a shard a page
+can be indexed via its (shard local) frame id. Frames added by Resize come in chunks
+that follow the initial frames of a shard in its own reserved address space.
+The data of the frames of a shard lives apart from the pages, in the shard's frame arena.*/
 
 namespace bustub {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new ClockReplacer(pool_size);
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+                                     size_t num_shards, ReplacerType replacer_type, size_t max_pool_size)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      num_shards_(num_shards),
+      replacer_type_(replacer_type),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_shards_ > 0 && num_shards_ <= pool_size_, "Every shard needs at least one frame.");
+  // We allocate a consecutive memory space for the book-keeping of the buffer pool, the data goes into the arenas.
+  pages_ = static_cast<Page *>(::operator new(pool_size * sizeof(Page)));
+  shards_ = new BufferPoolShard[num_shards_];
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+  // Every shard reserves room for the chunks it needs to take its share of the growth up to max_pool_size.
+  size_t chunk_frames = static_cast<size_t>(BUFFER_POOL_CHUNK_SIZE) * num_shards_;
+  size_t max_chunks = (max_pool_size_ - pool_size + chunk_frames - 1) / chunk_frames;
+
+  // Hand out the frames in contiguous slices, the first (pool_size % num_shards) shards get one extra frame.
+  size_t next_frame = 0;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard *shard = &shards_[i];
+    shard->pages_ = &pages_[next_frame];
+    shard->num_frames_ = pool_size / num_shards_ + (i < pool_size % num_shards_ ? 1 : 0);
+    shard->initial_frames_ = shard->num_frames_;
+    shard->max_frames_ = shard->initial_frames_ + max_chunks * BUFFER_POOL_CHUNK_SIZE;
+    if (shard->max_frames_ > shard->initial_frames_) {
+      // Only address space is reserved here, memory is committed as chunks are touched.
+      void *chunks = mmap(nullptr, max_chunks * BUFFER_POOL_CHUNK_SIZE * sizeof(Page), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      BUSTUB_ASSERT(chunks != MAP_FAILED, "Cannot reserve memory for the buffer pool to grow.");
+      shard->chunk_pages_ = static_cast<Page *>(chunks);
+    }
+    shard->arena_ = new FrameArena(shard->max_frames_, BUFFER_POOL_HUGE_PAGES);
+    shard->page_table_ = new PageTable(shard->max_frames_);
+    shard->replacer_ = CreateReplacer(shard->max_frames_);
+    // Initially, every page is in the free list.
+    for (size_t j = 0; j < shard->num_frames_; ++j) {
+      new (&shard->pages_[j]) Page(shard->arena_->GetFrameData(j));
+      shard->free_list_.emplace_back(static_cast<frame_id_t>(j));
+    }
+    next_frame += shard->num_frames_;
   }
 }
 
 BufferPoolManager::~BufferPoolManager() {
-  delete[] pages_;
-  delete replacer_;
+  StopBackgroundWriter();
+  StopReadAhead();
+  SaveWarmSnapshot();
+  delete compressed_cache_;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard *shard = &shards_[i];
+    for (size_t frame = 0; frame < shard->num_frames_; ++frame) {
+      shard->GetFrame(frame)->~Page();
+    }
+    if (shard->chunk_pages_ != nullptr) {
+      munmap(shard->chunk_pages_, (shard->max_frames_ - shard->initial_frames_) * sizeof(Page));
+    }
+    delete shard->arena_;
+    delete shard->replacer_;
+    delete shard->page_table_;
+  }
+  delete[] shards_;
+  ::operator delete(pages_);
+}
+
+Replacer *BufferPoolManager::CreateReplacer(size_t num_frames) {
+  switch (replacer_type_) {
+    case ReplacerType::LRU_K:
+      return new LRUKReplacer(num_frames, LRUK_REPLACER_K);
+    case ReplacerType::CLOCK:
+      return new ClockReplacer(num_frames);
+  }
+  UNREACHABLE("Unknown replacer type.");
+}
+
+bool BufferPoolManager::FindReplacementFrame(BufferPoolShard *shard, frame_id_t *frame_id, EvictedPage *evicted) {
+  /*Pages are always found from the free list first*/
+  if (!shard->free_list_.empty()) {
+    *frame_id = shard->free_list_.front();
+    shard->free_list_.pop_front();
+    return true;
+  }
+  /*Or else get a victim from the replacer. Victims that were pinned (or freed) since they entered the replacer are
+  dropped from it; a pinned frame comes back with its last unpin*/
+  while (shard->replacer_->Victim(frame_id)) {
+    Page *victim = shard->GetFrame(*frame_id);
+    if (victim->GetPageId() == INVALID_PAGE_ID || !victim->TryLockFrame()) {
+      continue;
+    }
+    shard->metrics_.evictions_.fetch_add(1, std::memory_order_relaxed);
+    /*If the victim is dirty, write it back before the frame is reused*/
+    if (victim->IsDirty()) {
+      victim->is_dirty_ = false;
+      shard->metrics_.dirty_writebacks_.fetch_add(1, std::memory_order_relaxed);
+      WriteToDisk(shard, victim->GetPageId(), victim->GetData());
+      /*The background writer fell behind, so let it start its next round right away*/
+      background_writer_cv_.notify_one();
+    }
+    /*The victim matches its copy on disk now, so it can move to the compressed tier. It is only copied here and
+    compressed once the latch is released; the reservation drops the copy if the page is read again before*/
+    if (compressed_cache_ != nullptr) {
+      evicted->page_id_ = victim->GetPageId();
+      evicted->reservation_ = compressed_cache_->Reserve(victim->GetPageId());
+      evicted->data_.assign(victim->GetData(), victim->GetData() + PAGE_SIZE);
+    }
+    shard->page_table_->Erase(victim->GetPageId());
+    return true;
+  }
+  return false;
+}
+
+bool BufferPoolManager::FindRingFrame(BufferPoolShard *shard, BufferAccessStrategy *strategy, page_id_t page_id,
+                                      frame_id_t *frame_id, EvictedPage *evicted) {
+  std::lock_guard<std::mutex> ring_guard(strategy->latch_);
+  auto &ring = strategy->ring_;
+  size_t shard_index = shard - shards_;
+  /*Until the ring is full, it grows by taking regular frames*/
+  if (ring.size() < strategy->ring_size_) {
+    if (!FindReplacementFrame(shard, frame_id, evicted)) {
+      return false;
+    }
+    ring.push_back({shard_index, *frame_id, page_id});
+    return true;
+  }
+  /*Recycle the oldest ring frame of this shard that still holds the ring's page and is not in use*/
+  for (size_t i = 0; i < ring.size(); i++) {
+    size_t slot_index = (strategy->next_slot_ + i) % ring.size();
+    auto &slot = ring[slot_index];
+    if (slot.shard_ != shard_index) {
+      continue;
+    }
+    Page *ring_page = shard->GetFrame(slot.frame_id_);
+    if (ring_page->GetPageId() != slot.page_id_ || !ring_page->TryLockFrame()) {
+      continue;
+    }
+    /*The frame is unpinned, so it sits in the replacer and has to be taken out, with the history of its old page*/
+    shard->replacer_->Remove(slot.frame_id_);
+    shard->metrics_.evictions_.fetch_add(1, std::memory_order_relaxed);
+    if (ring_page->IsDirty()) {
+      ring_page->is_dirty_ = false;
+      shard->metrics_.dirty_writebacks_.fetch_add(1, std::memory_order_relaxed);
+      WriteToDisk(shard, slot.page_id_, ring_page->GetData());
+    }
+    shard->page_table_->Erase(slot.page_id_);
+    slot.page_id_ = page_id;
+    *frame_id = slot.frame_id_;
+    strategy->next_slot_ = (slot_index + 1) % ring.size();
+    return true;
+  }
+  /*Nothing to recycle in this shard, so a regular frame replaces the oldest slot of the ring*/
+  if (!FindReplacementFrame(shard, frame_id, evicted)) {
+    return false;
+  }
+  ring[strategy->next_slot_] = {shard_index, *frame_id, page_id};
+  strategy->next_slot_ = (strategy->next_slot_ + 1) % ring.size();
+  return true;
+}
+
+bool BufferPoolManager::FindResidentFrame(BufferPoolShard *shard, std::unique_lock<std::mutex> *guard,
+                                          page_id_t page_id, frame_id_t *frame_id) {
+  /*Under the latch a locked frame is one whose I/O runs without the latch, the page may be gone once it completed*/
+  while (shard->page_table_->Find(page_id, frame_id)) {
+    if (!shard->GetFrame(*frame_id)->IsFrameLocked()) {
+      return true;
+    }
+    shard->io_done_cv_.wait(*guard);
+  }
+  return false;
+}
+
+void BufferPoolManager::CacheEvictedPage(const EvictedPage &evicted) {
+  if (evicted.page_id_ != INVALID_PAGE_ID) {
+    compressed_cache_->Insert(evicted.page_id_, evicted.data_.data(), evicted.reservation_);
+  }
 }
-//Frame id from free_list_ is same as page offset of buffer pool from which page can be taken to write/overwrite
-Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
+
+bool BufferPoolManager::TryPinResident(BufferPoolShard *shard, page_id_t page_id, Page **page) {
+  frame_id_t frame_id;
+  bool first_pin;
+  if (!shard->page_table_->Find(page_id, &frame_id) || !shard->GetFrame(frame_id)->TryPin(page_id, &first_pin)) {
+    return false;
+  }
+  if (first_pin) {
+    shard->replacer_->Pin(frame_id);
+  }
+  shard->metrics_.fetch_hits_.fetch_add(1, std::memory_order_relaxed);
+  *page = shard->GetFrame(frame_id);
+  (*page)->access_count_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+Page *BufferPoolManager::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -47,182 +234,139 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  BufferPoolShard *shard = GetShard(page_id);
+  Page *ref_page;
+  /*Resident pages are pinned without the shard latch*/
+  if (TryPinResident(shard, page_id, &ref_page)) {
+    return ref_page;
+  }
+  std::unique_lock<std::mutex> guard(shard->latch_);
+  /*The lock-free lookup can miss a page that is being moved in the page table or locked for I/O*/
+  frame_id_t page_frame;
+  if (FindResidentFrame(shard, &guard, page_id, &page_frame) && TryPinResident(shard, page_id, &ref_page)) {
+    return ref_page;
+  }
+
+  /*Otherwise bring it into a free or victimised frame, or into a frame of the caller's buffer ring*/
+  EvictedPage evicted;
+  bool found = strategy == nullptr ? FindReplacementFrame(shard, &page_frame, &evicted)
+                                   : FindRingFrame(shard, strategy, page_id, &page_frame, &evicted);
+  if (!found) {
+    shard->metrics_.failed_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  shard->metrics_.fetch_misses_.fetch_add(1, std::memory_order_relaxed);
+  ref_page = shard->GetFrame(page_frame);
+  ref_page->is_dirty_ = false;
+  ref_page->access_count_.store(1, std::memory_order_relaxed);
+  if (compressed_cache_ == nullptr || !compressed_cache_->Lookup(page_id, ref_page->data_)) {
+    ReadFromDisk(shard, page_id, ref_page->data_);
+  }
+  /*Publish the page only once its content is in place*/
+  ref_page->SetPinState(page_id, 1);
+  shard->page_table_->Insert(page_id, page_frame);
+  guard.unlock();
+  CacheEvictedPage(evicted);
+  return ref_page;
+}
 
-	frame_id_t page_frame;
-	/*Check if page is already in buffer pool*/
-	LOG_INFO("FetchPageImpl:: Fetch page id #%d",page_id);
-	if(page_table_.find(page_id) != page_table_.end()){
-		LOG_INFO("Page #%d found in buffer pool", page_id);
-		frame_id_t page_frame = page_table_[page_id];
-		Page *ref_page = &pages_[page_frame];
-		if(ref_page->GetPinCount() == 0){
-			replacer_->Pin(page_frame);
-		}
-		ref_page->pin_count_++;
-		return ref_page;
-	}
-
-	/*Check if free page is available*/
-	else if(!free_list_.empty()){
-		LOG_INFO("Page #%d found in free list", page_id);
-		frame_id_t page_frame = free_list_.front();
-		free_list_.pop_front();
-		Page *ref_page = &pages_[page_frame];
-		ref_page->pin_count_=1;
-		replacer_->Pin(page_frame);
-		ref_page->page_id_ = page_id;
-		char str_page[PAGE_SIZE];
-		disk_manager_->ReadPage(page_id,str_page);
-		std::strncpy(ref_page->data_,str_page,PAGE_SIZE);
-		page_table_[page_id] = page_frame;
-		ref_page->is_dirty_ = true;
-		return ref_page;
-	}
-
-	/*Or else get page from Replacer*/
-	else if(replacer_->Victim(&page_frame)){
-		LOG_INFO("Page #%d found in replacer", page_id);
-		/*Pin the page frame and page*/
-		Page *ref_page = &pages_[page_frame];
-		page_id_t old_pid = ref_page->GetPageId();
-		replacer_->Pin(page_frame);
-		ref_page->pin_count_=1;
-		char str_page[PAGE_SIZE];
-		/*If page is dirty, flush it*/
-		if(ref_page->IsDirty()){
-			FlushPageImpl(old_pid);
-		}
-		page_table_.erase(old_pid);
-		/*Add new details to the page*/
-		ref_page->page_id_ = page_id;
-		disk_manager_->ReadPage(page_id,str_page);
-		std::strncpy(ref_page->data_,str_page,PAGE_SIZE);
-		page_table_[page_id] = page_frame;
-		ref_page->is_dirty_ = true;
-		return ref_page;
-	}
-
-	return nullptr;
+bool BufferPoolManager::TryUnpinResident(BufferPoolShard *shard, page_id_t page_id, bool is_dirty) {
+  frame_id_t frame_id;
+  bool last_pin;
+  if (!shard->page_table_->Find(page_id, &frame_id) ||
+      !shard->GetFrame(frame_id)->TryUnpin(page_id, is_dirty, &last_pin)) {
+    return false;
+  }
+  /*If page is no longer in use, hand it to the replacer*/
+  if (last_pin) {
+    shard->replacer_->Unpin(frame_id);
+  }
+  return true;
 }
 
 bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
-	LOG_INFO("Page to be unpinned #%d",page_id);
-	if(page_table_.find(page_id) != page_table_.end()){
-		frame_id_t page_frame = page_table_[page_id];
-		Page *ref_page = &pages_[page_frame];
-		/*Check if page is pinned by one or more processes*/
-		if(ref_page->GetPinCount() >= 1){
-			ref_page->pin_count_ = ref_page->pin_count_ - 1;
-			/*Check if page is dirty*/
-			if(is_dirty == true){
-				LOG_INFO("Page #%d is dirty", page_id);
-				ref_page->is_dirty_ = true;
-			}
-			else{
-				LOG_INFO("Page #%d is not dirty", page_id);
-				ref_page->is_dirty_ = false;
-			}
-			/*If page is no longer in use, remove it from buffer pool and
-			add it to the replacer.*/
-			if(ref_page->GetPinCount() == 0){
-				LOG_INFO("Page #%d will be added to replacer and removed from buffer pool", page_id);
-				replacer_->Unpin(page_frame);
-			}
-			return true;
-		}
-		else{
-			return false;
-		}
-	}
-	if(is_dirty){}
-	return false;
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  BufferPoolShard *shard = GetShard(page_id);
+  if (TryUnpinResident(shard, page_id, is_dirty)) {
+    return true;
+  }
+  /*Under the latch the lookup is exact, so a failure means the page is not resident or not pinned*/
+  std::lock_guard<std::mutex> guard(shard->latch_);
+  return TryUnpinResident(shard, page_id, is_dirty);
 }
 
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
-  	/* Make sure you call DiskManager::WritePage! */
-	if(page_id == INVALID_PAGE_ID)
-		return false;
-	else if(page_table_.find(page_id) == page_table_.end())
-		return false;
-	else{
-		frame_id_t page_frame = page_table_[page_id];
-		Page *ref_page = &pages_[page_frame];
-		disk_manager_->WritePage(page_id,ref_page->GetData());
-		LOG_INFO("Page #%d is flushed", page_id);
-		return true;
-	}
-}
-
-Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
-  	// 0.   Make sure you call DiskManager::AllocatePage!
-  	// 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  	// 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
-  	// 3.   Update P's metadata, zero out memory and add P to the page table.
-  	// 4.   Set the page ID output parameter. Return a pointer to P.
-	int flag = 0;
-	frame_id_t page_frame;
-	page_id_t pid = disk_manager_->AllocatePage();
-	LOG_INFO("New page #%d from replacer",pid);
-	/*Check if there is space for new page in buffer pool*/
-	if(page_table_.size() == pool_size_){
-		for(auto it = page_table_.begin(); it != page_table_.end(); it++){
-			Page *ref_page = &pages_[it->second];
-			if(ref_page->GetPinCount() < 1){
-				// LOG_INFO("Flag0");
-				flag = 0;
-				break;
-			}
-			else{
-				// LOG_INFO("Flag1");
-				flag = 1;
-				continue;
-			}
-		}
-		/*If there is no space, return nullptr*/
-		if(flag == 1){
-			LOG_INFO("NewPageImpl::No space for new page");
-			return nullptr;
-		}
-	}
-	/*Get page from free list*/
-	if(!free_list_.empty()){
-		frame_id_t page_frame = free_list_.front();
-		free_list_.pop_front();
-		LOG_INFO("New page #%d from free list",pid);
-		Page *ref_page = &pages_[page_frame];
-		*page_id = pid;
-		/*Set parameters for the page*/
-		ref_page->page_id_ = pid;
-		ref_page->pin_count_ = 1;
-		ref_page->ResetMemory();
-		ref_page->is_dirty_ = false;
-		/*Put the page in page table */
-		replacer_->Pin(page_frame);
-		page_table_[pid] = page_frame;
-		return ref_page;
-	}
-	/*Or else get page from Replacer*/
-	else if(replacer_->Victim(&page_frame)){
-		Page *ref_page = &pages_[page_frame];
-		*page_id = pid;
-		page_id_t old_pid = ref_page->page_id_;
-		/*If page is dirty, flush it*/
-		if(ref_page->IsDirty()){
-			FlushPageImpl(old_pid);
-			LOG_INFO("Page #%d, frame #%d", old_pid,page_frame);
-		}
-		page_table_.erase(old_pid);
-		/*Set parameters for the page*/
-		ref_page->pin_count_ = 1;
-		ref_page->page_id_ = pid;
-		ref_page->ResetMemory();
-		ref_page->is_dirty_ = false;
-		/*Put the page in page table*/
-		page_table_[pid] = page_frame;
-		replacer_->Pin(page_frame);
-		return ref_page;
-	}
-	return nullptr;
+  /* Make sure you call DiskManager::WritePage! */
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  BufferPoolShard *shard = GetShard(page_id);
+  std::unique_lock<std::mutex> guard(shard->latch_);
+
+  frame_id_t page_frame;
+  if (!FindResidentFrame(shard, &guard, page_id, &page_frame)) {
+    return false;
+  }
+  Page *ref_page = shard->GetFrame(page_frame);
+  /*Clear the dirty flag first, so a concurrent writer who unpins during the write marks the page dirty again*/
+  ref_page->is_dirty_ = false;
+  WriteToDisk(shard, page_id, ref_page->GetData());
+  return true;
+}
+
+Page *BufferPoolManager::NewPageImpl(page_id_t *page_id, PageExtent *extent) {
+  // 0.   Make sure you call DiskManager::AllocatePage!
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  // 3.   Update P's metadata, zero out memory and add P to the page table.
+  // 4.   Set the page ID output parameter. Return a pointer to P.
+  /*A page of an extent is only allocated once it has a frame, until then it stays reserved for the extent*/
+  page_id_t pid;
+  if (extent != nullptr) {
+    if (extent->next_page_id_ == extent->end_page_id_) {
+      extent->next_page_id_ = disk_manager_->ReserveExtent(extent->size_);
+      extent->end_page_id_ = extent->next_page_id_ + static_cast<page_id_t>(extent->size_);
+    }
+    pid = extent->next_page_id_;
+  } else {
+    pid = disk_manager_->AllocatePage();
+  }
+  BufferPoolShard *shard = GetShard(pid);
+  std::unique_lock<std::mutex> guard(shard->latch_);
+
+  frame_id_t page_frame;
+  EvictedPage evicted;
+  /*If every frame of the shard is pinned there is no space for the new page*/
+  if (!FindReplacementFrame(shard, &page_frame, &evicted)) {
+    shard->metrics_.failed_allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (extent == nullptr) {
+      disk_manager_->DeallocatePage(pid);
+    }
+    *page_id = INVALID_PAGE_ID;
+    return nullptr;
+  }
+  shard->metrics_.new_pages_.fetch_add(1, std::memory_order_relaxed);
+  if (extent != nullptr) {
+    disk_manager_->AllocateReservedPage(pid);
+    extent->next_page_id_++;
+  }
+  Page *ref_page = shard->GetFrame(page_frame);
+  /*Set parameters for the page*/
+  ref_page->ResetMemory();
+  ref_page->is_dirty_ = false;
+  ref_page->access_count_.store(1, std::memory_order_relaxed);
+  ref_page->SetPinState(pid, 1);
+  /*Put the page in page table*/
+  shard->page_table_->Insert(pid, page_frame);
+  *page_id = pid;
+  guard.unlock();
+  CacheEvictedPage(evicted);
+  return ref_page;
 }
 
 bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
@@ -231,29 +375,735 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-	if(page_table_.find(page_id) != page_table_.end()){
-		frame_id_t page_frame = page_table_[page_id];
-		Page *ref_page = &pages_[page_frame];
-		if(ref_page->GetPinCount() < 1){
-			LOG_INFO("Deleting page #%d",page_id);
-			ref_page->ResetMemory();
-			page_table_.erase(page_id);
-			free_list_.push_back(page_frame);
-			return true;
-		}
-		else{
-			LOG_INFO("Page #%d cannot be deleted because it is in use",page_id);
-			return false;
-		}
-	}
-	return true;
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  BufferPoolShard *shard = GetShard(page_id);
+  std::unique_lock<std::mutex> guard(shard->latch_);
+
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  frame_id_t page_frame;
+  if (!FindResidentFrame(shard, &guard, page_id, &page_frame)) {
+    disk_manager_->DeallocatePage(page_id);
+    return true;
+  }
+  Page *ref_page = shard->GetFrame(page_frame);
+  if (!ref_page->TryLockFrame()) {
+    /*Page cannot be deleted because it is in use*/
+    return false;
+  }
+  /*The frame is unpinned, so it has to be taken out of the replacer before it goes back to the free list*/
+  shard->replacer_->Remove(page_frame);
+  shard->page_table_->Erase(page_id);
+  ref_page->is_dirty_ = false;
+  ref_page->ResetMemory();
+  ref_page->SetPinState(INVALID_PAGE_ID, 0);
+  shard->free_list_.push_back(page_frame);
+  disk_manager_->DeallocatePage(page_id);
+  return true;
 }
 
 void BufferPoolManager::FlushAllPagesImpl() {
-	/*Go through the whole page table and flush each page*/
-	for(auto it=page_table_.begin();it != page_table_.end();it++){
-		FlushPage(it->first);
-	}
+  /*Consecutive page ids live in different shards, so all shards are latched (in index order) to coalesce runs*/
+  std::vector<std::unique_lock<std::mutex>> guards;
+  guards.reserve(num_shards_);
+  std::vector<Page *> dirty_pages;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard *shard = &shards_[i];
+    guards.emplace_back(shard->latch_);
+    /*Writes that run without the latch have to be on disk before the flush returns*/
+    shard->io_done_cv_.wait(guards.back(), [shard] { return shard->writes_in_flight_ == 0; });
+    for (size_t frame = 0; frame < shard->num_frames_; ++frame) {
+      Page *ref_page = shard->GetFrame(frame);
+      if (ref_page->GetPageId() != INVALID_PAGE_ID && ref_page->IsDirty()) {
+        dirty_pages.push_back(ref_page);
+      }
+    }
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end(),
+            [](Page *a, Page *b) { return a->GetPageId() < b->GetPageId(); });
+
+  /*Write-ahead logging: the log goes first, up to the newest page of the flush*/
+  lsn_t max_lsn = INVALID_LSN;
+  for (Page *dirty_page : dirty_pages) {
+    max_lsn = std::max(max_lsn, dirty_page->GetLSN());
+  }
+  ForceLog(max_lsn);
+
+  /*Write every run of consecutive page ids with one call*/
+  std::vector<const char *> run;
+  size_t next = 0;
+  while (next < dirty_pages.size()) {
+    page_id_t first_page_id = dirty_pages[next]->GetPageId();
+    page_id_t next_page_id = first_page_id;
+    run.clear();
+    while (next < dirty_pages.size() && dirty_pages[next]->GetPageId() == next_page_id) {
+      run.push_back(dirty_pages[next]->GetData());
+      dirty_pages[next]->is_dirty_ = false;
+      next++;
+      next_page_id++;
+    }
+    auto start = std::chrono::steady_clock::now();
+    disk_manager_->WritePages(first_page_id, run.data(), run.size());
+    GetShard(first_page_id)->metrics_.write_latency_.Record(std::chrono::steady_clock::now() - start);
+  }
+  /*One sync makes the whole flush durable*/
+  if (!dirty_pages.empty()) {
+    disk_manager_->Sync();
+  }
 }
 
+size_t BufferPoolManager::Resize(size_t pool_size) {
+  std::lock_guard<std::mutex> resize_guard(resize_latch_);
+  /*Grow the smallest shard first, so the shards stay balanced*/
+  while (pool_size_ < pool_size) {
+    BufferPoolShard *smallest = nullptr;
+    for (size_t i = 0; i < num_shards_; ++i) {
+      BufferPoolShard *shard = &shards_[i];
+      if (shard->num_frames_ < shard->max_frames_ &&
+          (smallest == nullptr || shard->num_frames_ < smallest->num_frames_)) {
+        smallest = shard;
+      }
+    }
+    if (smallest == nullptr || !GrowShard(smallest)) {
+      break;
+    }
+  }
+  /*Shrink the largest shard first; a shard whose last chunk is in use is passed over until the next call*/
+  std::vector<BufferPoolShard *> candidates;
+  while (pool_size_ >= pool_size + BUFFER_POOL_CHUNK_SIZE) {
+    candidates.clear();
+    for (size_t i = 0; i < num_shards_; ++i) {
+      if (shards_[i].num_frames_ > shards_[i].initial_frames_) {
+        candidates.push_back(&shards_[i]);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](BufferPoolShard *a, BufferPoolShard *b) { return a->num_frames_ > b->num_frames_; });
+    auto released = std::find_if(candidates.begin(), candidates.end(),
+                                 [this](BufferPoolShard *shard) { return ShrinkShard(shard); });
+    if (released == candidates.end()) {
+      break;
+    }
+  }
+  return pool_size_;
 }
+
+bool BufferPoolManager::GrowShard(BufferPoolShard *shard) {
+  std::lock_guard<std::mutex> guard(shard->latch_);
+  if (shard->num_frames_ + BUFFER_POOL_CHUNK_SIZE > shard->max_frames_) {
+    return false;
+  }
+  for (size_t frame = shard->num_frames_; frame < shard->num_frames_ + BUFFER_POOL_CHUNK_SIZE; ++frame) {
+    new (shard->GetFrame(frame)) Page(shard->arena_->GetFrameData(frame));
+    shard->free_list_.emplace_back(static_cast<frame_id_t>(frame));
+  }
+  shard->num_frames_ += BUFFER_POOL_CHUNK_SIZE;
+  pool_size_ += BUFFER_POOL_CHUNK_SIZE;
+  return true;
+}
+
+bool BufferPoolManager::ShrinkShard(BufferPoolShard *shard) {
+  std::lock_guard<std::mutex> guard(shard->latch_);
+  if (shard->num_frames_ == shard->initial_frames_) {
+    return false;
+  }
+  size_t first_frame = shard->num_frames_ - BUFFER_POOL_CHUNK_SIZE;
+  /*Lock every resident page of the chunk first, so nothing is evicted unless the whole chunk can go*/
+  std::vector<size_t> locked_frames;
+  for (size_t frame = first_frame; frame < shard->num_frames_; ++frame) {
+    Page *page = shard->GetFrame(frame);
+    if (page->GetPageId() == INVALID_PAGE_ID) {
+      continue;
+    }
+    if (!page->TryLockFrame()) {
+      for (size_t locked_frame : locked_frames) {
+        Page *locked_page = shard->GetFrame(locked_frame);
+        locked_page->SetPinState(locked_page->GetPageId(), 0);
+      }
+      return false;
+    }
+    locked_frames.push_back(frame);
+  }
+  for (size_t frame : locked_frames) {
+    Page *page = shard->GetFrame(frame);
+    page_id_t page_id = page->GetPageId();
+    shard->replacer_->Remove(static_cast<frame_id_t>(frame));
+    shard->metrics_.evictions_.fetch_add(1, std::memory_order_relaxed);
+    if (page->IsDirty()) {
+      page->is_dirty_ = false;
+      shard->metrics_.dirty_writebacks_.fetch_add(1, std::memory_order_relaxed);
+      WriteToDisk(shard, page_id, page->GetData());
+    }
+    shard->page_table_->Erase(page_id);
+    page->SetPinState(INVALID_PAGE_ID, 0);
+  }
+  shard->free_list_.remove_if(
+      [first_frame](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= first_frame; });
+  for (size_t frame = first_frame; frame < shard->num_frames_; ++frame) {
+    shard->GetFrame(frame)->~Page();
+  }
+  shard->arena_->Release(first_frame, BUFFER_POOL_CHUNK_SIZE);
+  /*Give the memory back to the system. The range stays mapped and reads back as zeroes, which a lock-free lookup that
+  still holds one of these frame ids sees as an empty frame. Partially covered system pages stay committed.*/
+  auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  auto begin = reinterpret_cast<uintptr_t>(shard->GetFrame(first_frame));
+  auto end = begin + BUFFER_POOL_CHUNK_SIZE * sizeof(Page);
+  begin = (begin + page_size - 1) & ~(page_size - 1);
+  end &= ~(page_size - 1);
+  if (begin < end) {
+    madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+  }
+  shard->num_frames_ = first_frame;
+  pool_size_ -= BUFFER_POOL_CHUNK_SIZE;
+  return true;
+}
+
+void BufferPoolManager::EnableCompressedCache(size_t capacity) {
+  BUSTUB_ASSERT(compressed_cache_ == nullptr, "The compressed cache is already enabled.");
+  compressed_cache_ = new CompressedPageCache(capacity);
+}
+
+CompressedPageCacheStats BufferPoolManager::GetCompressedCacheStats() {
+  return compressed_cache_ == nullptr ? CompressedPageCacheStats() : compressed_cache_->GetStats();
+}
+
+size_t BufferPoolManager::EnableWarmRestart(const std::string &snapshot_file) {
+  warm_snapshot_file_ = snapshot_file;
+  std::ifstream in(snapshot_file, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t num_entries = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&num_entries), sizeof(num_entries));
+  if (!in || magic != WARM_SNAPSHOT_MAGIC) {
+    return 0;
+  }
+  std::vector<WarmSnapshotEntry> entries(num_entries);
+  in.read(reinterpret_cast<char *>(entries.data()), num_entries * sizeof(WarmSnapshotEntry));
+  if (!in) {
+    LOG_DEBUG("Ignoring a truncated warm snapshot");
+    return 0;
+  }
+
+  /*Hand out free frames to the hottest pages first, the rest will be read on demand*/
+  struct WarmLoad {
+    page_id_t page_id_;
+    uint32_t rank_;
+    BufferPoolShard *shard_;
+    frame_id_t frame_id_;
+  };
+  std::vector<std::unique_lock<std::mutex>> guards;
+  guards.reserve(num_shards_);
+  for (size_t i = 0; i < num_shards_; ++i) {
+    guards.emplace_back(shards_[i].latch_);
+  }
+  std::vector<WarmLoad> loads;
+  for (const auto &entry : entries) {
+    /*A page deallocated since the snapshot must not be resident, it is handed out again by NewPage*/
+    if (entry.page_id_ < 0 || !disk_manager_->IsPageAllocated(entry.page_id_)) {
+      continue;
+    }
+    BufferPoolShard *shard = GetShard(entry.page_id_);
+    frame_id_t frame_id;
+    if (shard->free_list_.empty() || shard->page_table_->Find(entry.page_id_, &frame_id)) {
+      continue;
+    }
+    frame_id = shard->free_list_.front();
+    shard->free_list_.pop_front();
+    loads.push_back({entry.page_id_, entry.rank_, shard, frame_id});
+  }
+
+  /*Read the pages in page id order, every run of consecutive page ids with one vectored read*/
+  std::sort(loads.begin(), loads.end(), [](const WarmLoad &a, const WarmLoad &b) { return a.page_id_ < b.page_id_; });
+  std::vector<std::pair<size_t, size_t>> runs;
+  for (size_t next = 0; next < loads.size(); ++next) {
+    if (runs.empty() || loads[next].page_id_ != loads[next - 1].page_id_ + 1) {
+      runs.emplace_back(next, 0);
+    }
+    runs.back().second++;
+  }
+  std::atomic<size_t> next_run{0};
+  auto read_runs = [&]() {
+    std::vector<char *> run_data;
+    for (size_t run = next_run++; run < runs.size(); run = next_run++) {
+      run_data.clear();
+      for (size_t i = runs[run].first; i < runs[run].first + runs[run].second; ++i) {
+        run_data.push_back(loads[i].shard_->GetFrame(loads[i].frame_id_)->data_);
+      }
+      const WarmLoad &first = loads[runs[run].first];
+      auto start = std::chrono::steady_clock::now();
+      disk_manager_->ReadPages(first.page_id_, run_data.data(), run_data.size());
+      first.shard_->metrics_.read_latency_.Record(std::chrono::steady_clock::now() - start);
+    }
+  };
+  std::vector<std::thread> readers;
+  for (size_t i = 1; i < std::min<size_t>(WARM_RESTART_THREADS, runs.size()); ++i) {
+    readers.emplace_back(read_runs);
+  }
+  read_runs();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  /*Publish the pages coldest first, so the replacer evicts the cold ones before the hot ones*/
+  std::stable_sort(loads.begin(), loads.end(), [](const WarmLoad &a, const WarmLoad &b) { return a.rank_ > b.rank_; });
+  for (const auto &load : loads) {
+    Page *page = load.shard_->GetFrame(load.frame_id_);
+    page->is_dirty_ = false;
+    page->access_count_.store(0, std::memory_order_relaxed);
+    page->SetPinState(load.page_id_, 0);
+    load.shard_->page_table_->Insert(load.page_id_, load.frame_id_);
+    load.shard_->replacer_->Unpin(load.frame_id_);
+  }
+  return loads.size();
+}
+
+void BufferPoolManager::SaveWarmSnapshot() {
+  if (warm_snapshot_file_.empty()) {
+    return;
+  }
+  std::vector<std::pair<uint32_t, page_id_t>> resident;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard *shard = &shards_[i];
+    std::lock_guard<std::mutex> guard(shard->latch_);
+    for (size_t frame = 0; frame < shard->num_frames_; ++frame) {
+      Page *page = shard->GetFrame(frame);
+      page_id_t page_id = page->GetPageId();
+      if (page_id != INVALID_PAGE_ID) {
+        resident.emplace_back(page->access_count_.load(std::memory_order_relaxed), page_id);
+      }
+    }
+  }
+  std::sort(resident.begin(), resident.end(),
+            [](const auto &a, const auto &b) { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+  std::vector<WarmSnapshotEntry> entries;
+  entries.reserve(resident.size());
+  uint32_t rank = 0;
+  for (size_t i = 0; i < resident.size(); ++i) {
+    if (i > 0 && resident[i].first != resident[i - 1].first) {
+      rank++;
+    }
+    entries.push_back({resident[i].second, rank});
+  }
+
+  /*Write and sync a new file, then rename it over the old one and sync the directory, so a crash leaves either the
+   * old or the new snapshot behind, never a torn one*/
+  uint32_t header[2] = {WARM_SNAPSHOT_MAGIC, static_cast<uint32_t>(entries.size())};
+  std::vector<char> data(sizeof(header) + entries.size() * sizeof(WarmSnapshotEntry));
+  memcpy(data.data(), header, sizeof(header));
+  memcpy(data.data() + sizeof(header), entries.data(), entries.size() * sizeof(WarmSnapshotEntry));
+  std::string tmp_file = warm_snapshot_file_ + ".tmp";
+  int fd = open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  bool ok = fd != -1;
+  for (size_t done = 0; ok && done < data.size();) {
+    ssize_t written = write(fd, data.data() + done, data.size() - done);
+    ok = written > 0;
+    done += ok ? static_cast<size_t>(written) : 0;
+  }
+  ok = ok && fsync(fd) == 0;
+  if (fd != -1) {
+    close(fd);
+  }
+  if (!ok || std::rename(tmp_file.c_str(), warm_snapshot_file_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while saving the warm snapshot");
+    return;
+  }
+  std::string::size_type slash = warm_snapshot_file_.rfind('/');
+  std::string dir = slash == std::string::npos ? "." : warm_snapshot_file_.substr(0, std::max<size_t>(slash, 1));
+  int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir_fd == -1 || fsync(dir_fd) != 0) {
+    LOG_DEBUG("I/O error while syncing the directory of the warm snapshot");
+  }
+  if (dir_fd != -1) {
+    close(dir_fd);
+  }
+}
+
+void BufferPoolManager::ReadFromDisk(BufferPoolShard *shard, page_id_t page_id, char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  disk_manager_->ReadPage(page_id, page_data);
+  shard->metrics_.read_latency_.Record(std::chrono::steady_clock::now() - start);
+}
+
+void BufferPoolManager::ForceLog(lsn_t lsn) {
+  if (enable_logging && log_manager_ != nullptr && lsn > log_manager_->GetPersistentLSN()) {
+    log_manager_->Flush(lsn);
+  }
+}
+
+void BufferPoolManager::WriteToDisk(BufferPoolShard *shard, page_id_t page_id, const char *page_data) {
+  lsn_t lsn;
+  memcpy(&lsn, page_data + Page::OFFSET_LSN, sizeof(lsn_t));
+  ForceLog(lsn);
+  auto start = std::chrono::steady_clock::now();
+  disk_manager_->WritePage(page_id, page_data);
+  shard->metrics_.write_latency_.Record(std::chrono::steady_clock::now() - start);
+}
+
+BufferPoolMetrics BufferPoolManager::GetMetrics() {
+  BufferPoolMetrics metrics;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    metrics.Add(shards_[i].metrics_);
+  }
+  return metrics;
+}
+
+BufferPoolMetrics BufferPoolManager::GetShardMetrics(size_t shard_index) {
+  BUSTUB_ASSERT(shard_index < num_shards_, "Shard index out of range.");
+  BufferPoolMetrics metrics;
+  metrics.Add(shards_[shard_index].metrics_);
+  return metrics;
+}
+
+void BufferPoolManager::ReadAhead(page_id_t page_id, next_page_fn next_page_fn, BufferAccessStrategy *strategy) {
+  size_t depth = read_ahead_depth_;
+  if (page_id == INVALID_PAGE_ID || depth == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(read_ahead_latch_);
+  bool dropped = read_ahead_stop_ || read_ahead_queue_.size() >= READ_AHEAD_QUEUE_SIZE;
+  ReadAheadRequest request{page_id, depth, next_page_fn, strategy, 0};
+  if (strategy != nullptr) {
+    std::lock_guard<std::mutex> ring_guard(strategy->latch_);
+    /*The scan moved on by one page. If it overtook the read-ahead, the horizon starts over at page_id*/
+    size_t position = ++strategy->read_ahead_position_;
+    if (strategy->read_ahead_horizon_ <= position) {
+      strategy->read_ahead_horizon_ = position;
+      strategy->read_ahead_next_ = page_id;
+    }
+    /*Extend the horizon to depth pages ahead of the scan once less than half of that is left, one request at a time*/
+    size_t ahead = strategy->read_ahead_horizon_ - position;
+    if (dropped || strategy->pending_read_ahead_ > 0 || strategy->read_ahead_next_ == INVALID_PAGE_ID ||
+        ahead > depth / 2) {
+      return;
+    }
+    request.page_id_ = strategy->read_ahead_next_;
+    request.depth_ = depth - ahead;
+    request.position_ = strategy->read_ahead_horizon_;
+    strategy->pending_read_ahead_++;
+  } else if (dropped) {
+    return;
+  }
+  if (read_ahead_thread_ == nullptr) {
+    read_ahead_thread_ = new std::thread(&BufferPoolManager::RunReadAhead, this);
+  }
+  read_ahead_queue_.push_back(request);
+  read_ahead_cv_.notify_one();
+}
+
+void BufferPoolManager::RunReadAhead() {
+  std::unique_lock<std::mutex> latch(read_ahead_latch_);
+  while (true) {
+    read_ahead_cv_.wait(latch, [this] { return read_ahead_stop_ || !read_ahead_queue_.empty(); });
+    if (read_ahead_stop_) {
+      return;
+    }
+    ReadAheadRequest request = read_ahead_queue_.front();
+    read_ahead_queue_.pop_front();
+    latch.unlock();
+    ProcessReadAhead(request);
+    latch.lock();
+  }
+}
+
+void BufferPoolManager::ProcessReadAhead(const ReadAheadRequest &request) {
+  page_id_t page_id = request.page_id_;
+  size_t walked = 0;
+  std::vector<ReadAheadLoad> loads;
+  while (walked < request.depth_ && page_id != INVALID_PAGE_ID) {
+    page_id_t next_page_id;
+    if (!PeekNextPageId(page_id, request.next_page_fn_, &next_page_id)) {
+      /*The page is missing. Tables grow by extents, so the pages after it most likely have the following ids and are
+      missing too: they are read together with it, as far as the request goes*/
+      loads.clear();
+      for (page_id_t run_page_id = page_id; loads.size() < request.depth_ - walked; run_page_id++) {
+        ReadAheadLoad load;
+        if ((run_page_id != page_id && !disk_manager_->IsPageAllocated(run_page_id)) ||
+            !LockFrameForRead(run_page_id, request.strategy_, &load)) {
+          break;
+        }
+        loads.push_back(load);
+      }
+      ReadLockedFrames(&loads);
+      /*Every frame is pinned or the read failed, the pages will be read on demand*/
+      if (!PeekNextPageId(page_id, request.next_page_fn_, &next_page_id)) {
+        page_id = INVALID_PAGE_ID;
+        break;
+      }
+    }
+    walked++;
+    page_id = next_page_id;
+  }
+  if (request.strategy_ != nullptr) {
+    std::lock_guard<std::mutex> ring_guard(request.strategy_->latch_);
+    /*Move the horizon past the walked pages, unless the scan overtook the request and moved it already*/
+    if (request.strategy_->read_ahead_horizon_ == request.position_) {
+      request.strategy_->read_ahead_horizon_ += walked;
+      request.strategy_->read_ahead_next_ = page_id;
+    }
+    request.strategy_->pending_read_ahead_--;
+    request.strategy_->read_ahead_done_.notify_all();
+  }
+}
+
+bool BufferPoolManager::PeekNextPageId(page_id_t page_id, next_page_fn next_page_fn, page_id_t *next_page_id) {
+  BufferPoolShard *shard = GetShard(page_id);
+  frame_id_t frame_id;
+  bool first_pin;
+  if (!shard->page_table_->Find(page_id, &frame_id) || !shard->GetFrame(frame_id)->TryPin(page_id, &first_pin)) {
+    std::unique_lock<std::mutex> guard(shard->latch_);
+    if (!FindResidentFrame(shard, &guard, page_id, &frame_id) ||
+        !shard->GetFrame(frame_id)->TryPin(page_id, &first_pin)) {
+      return false;
+    }
+  }
+  Page *page = shard->GetFrame(frame_id);
+  page->RLatch();
+  *next_page_id = next_page_fn(page);
+  page->RUnlatch();
+  /*The frame stayed in the replacer while it was pinned. Victim drops a pinned frame, so the last unpin puts it back*/
+  bool last_pin;
+  if (page->TryUnpin(page_id, false, &last_pin) && last_pin) {
+    shard->replacer_->Release(frame_id);
+  }
+  return true;
+}
+
+bool BufferPoolManager::LockFrameForRead(page_id_t page_id, BufferAccessStrategy *strategy, ReadAheadLoad *load) {
+  BufferPoolShard *shard = GetShard(page_id);
+  std::unique_lock<std::mutex> guard(shard->latch_);
+  frame_id_t frame_id;
+  if (shard->page_table_->Find(page_id, &frame_id)) {
+    return false;
+  }
+  EvictedPage evicted;
+  bool found = strategy == nullptr ? FindReplacementFrame(shard, &frame_id, &evicted)
+                                   : FindRingFrame(shard, strategy, page_id, &frame_id, &evicted);
+  if (!found) {
+    return false;
+  }
+  Page *page = shard->GetFrame(frame_id);
+  page->is_dirty_ = false;
+  page->access_count_.store(0, std::memory_order_relaxed);
+  /*The page is in the page table right away, so a fetch of it waits for the read instead of reading it again*/
+  page->SetPinState(page_id, Page::PIN_COUNT_LOCKED);
+  shard->page_table_->Insert(page_id, frame_id);
+  *load = {shard, frame_id, page_id, false};
+  guard.unlock();
+  CacheEvictedPage(evicted);
+  return true;
+}
+
+void BufferPoolManager::ReadLockedFrames(std::vector<ReadAheadLoad> *loads) {
+  std::mutex done_latch;
+  std::condition_variable done_cv;
+  size_t in_flight = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto &load : *loads) {
+    char *page_data = load.shard_->GetFrame(load.frame_id_)->data_;
+    if (compressed_cache_ != nullptr && compressed_cache_->Lookup(load.page_id_, page_data)) {
+      load.success_ = true;
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> done_guard(done_latch);
+      in_flight++;
+    }
+    ReadAheadLoad *pending = &load;
+    disk_manager_->ReadPageAsync(load.page_id_, page_data, [&, pending](bool success) {
+      pending->shard_->metrics_.read_latency_.Record(std::chrono::steady_clock::now() - start);
+      std::lock_guard<std::mutex> done_guard(done_latch);
+      pending->success_ = success;
+      if (--in_flight == 0) {
+        done_cv.notify_one();
+      }
+    });
+  }
+  {
+    std::unique_lock<std::mutex> done_lock(done_latch);
+    done_cv.wait(done_lock, [&] { return in_flight == 0; });
+  }
+  for (const auto &load : *loads) {
+    BufferPoolShard *shard = load.shard_;
+    Page *page = shard->GetFrame(load.frame_id_);
+    std::lock_guard<std::mutex> guard(shard->latch_);
+    if (load.success_) {
+      shard->metrics_.read_ahead_pages_.fetch_add(1, std::memory_order_relaxed);
+      page->SetPinState(load.page_id_, 0);
+      /*Evictable, but not counted as a use until the scan gets to the page*/
+      shard->replacer_->Release(load.frame_id_);
+    } else {
+      shard->page_table_->Erase(load.page_id_);
+      page->SetPinState(INVALID_PAGE_ID, 0);
+      shard->free_list_.push_back(load.frame_id_);
+    }
+    shard->io_done_cv_.notify_all();
+  }
+}
+
+void BufferPoolManager::StopReadAhead() {
+  std::thread *read_ahead_thread;
+  {
+    std::lock_guard<std::mutex> guard(read_ahead_latch_);
+    read_ahead_stop_ = true;
+    read_ahead_cv_.notify_all();
+    read_ahead_thread = read_ahead_thread_;
+    read_ahead_thread_ = nullptr;
+  }
+  if (read_ahead_thread != nullptr) {
+    read_ahead_thread->join();
+    delete read_ahead_thread;
+  }
+  /*Release the strategies of the requests that will never run. Concurrent ReadAhead calls still look at the queue, so
+  it is drained under its latch*/
+  std::lock_guard<std::mutex> guard(read_ahead_latch_);
+  for (const auto &request : read_ahead_queue_) {
+    if (request.strategy_ != nullptr) {
+      std::lock_guard<std::mutex> ring_guard(request.strategy_->latch_);
+      request.strategy_->pending_read_ahead_--;
+      request.strategy_->read_ahead_done_.notify_all();
+    }
+  }
+  read_ahead_queue_.clear();
+}
+
+void BufferPoolManager::RunBackgroundWriter(double clean_target, std::chrono::milliseconds interval) {
+  BUSTUB_ASSERT(clean_target >= 0 && clean_target <= 1, "The clean target is a fraction of the evictable frames.");
+  std::lock_guard<std::mutex> guard(background_writer_latch_);
+  clean_target_ = clean_target;
+  background_writer_interval_ = interval;
+  if (background_writer_thread_ == nullptr) {
+    background_writer_stop_ = false;
+    background_writer_thread_ = new std::thread(&BufferPoolManager::BackgroundWriterLoop, this);
+  }
+}
+
+void BufferPoolManager::StopBackgroundWriter() {
+  std::thread *background_writer_thread;
+  {
+    std::lock_guard<std::mutex> guard(background_writer_latch_);
+    background_writer_stop_ = true;
+    background_writer_cv_.notify_all();
+    background_writer_thread = background_writer_thread_;
+    background_writer_thread_ = nullptr;
+  }
+  if (background_writer_thread != nullptr) {
+    background_writer_thread->join();
+    delete background_writer_thread;
+  }
+}
+
+BackgroundWriterStats BufferPoolManager::GetBackgroundWriterStats() {
+  return {background_pages_written_.load(), background_write_rate_.load(), background_queue_depth_.load()};
+}
+
+void BufferPoolManager::BackgroundWriterLoop() {
+  auto last_round = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> latch(background_writer_latch_);
+  while (!background_writer_stop_) {
+    latch.unlock();
+    size_t pages_written = 0;
+    for (size_t i = 0; i < num_shards_; ++i) {
+      pages_written += CleanShard(&shards_[i]);
+    }
+    /*The rate covers the time since the previous round, including the wait in between*/
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = now - last_round;
+    last_round = now;
+    background_write_rate_ = elapsed.count() > 0 ? pages_written / elapsed.count() : 0;
+    latch.lock();
+    background_writer_cv_.wait_for(latch, background_writer_interval_);
+  }
+}
+
+size_t BufferPoolManager::CleanShard(BufferPoolShard *shard) {
+  size_t needed;
+  {
+    std::lock_guard<std::mutex> guard(shard->latch_);
+    /*Free frames are clean and evictable, resident frames only once they are unpinned*/
+    size_t evictable = shard->free_list_.size();
+    size_t clean = evictable;
+    size_t dirty = 0;
+    for (size_t frame = 0; frame < shard->num_frames_; ++frame) {
+      Page *page = shard->GetFrame(frame);
+      if (page->GetPageId() != INVALID_PAGE_ID && page->GetPinCount() == 0) {
+        evictable++;
+        page->IsDirty() ? dirty++ : clean++;
+      }
+    }
+    size_t target = static_cast<size_t>(clean_target_ * evictable + 0.5);
+    needed = target > clean ? std::min(target - clean, dirty) : 0;
+  }
+  background_queue_depth_ += needed;
+
+  size_t pages_written = 0;
+  std::vector<std::pair<frame_id_t, Page *>> batch;
+  while (needed > 0) {
+    /*The frames are locked during the writes, so nobody can pin and modify them halfway through*/
+    batch.clear();
+    {
+      std::lock_guard<std::mutex> guard(shard->latch_);
+      size_t batch_size = std::min(needed, BACKGROUND_WRITE_BATCH);
+      for (size_t frame = 0; frame < shard->num_frames_ && batch.size() < batch_size; ++frame) {
+        Page *page = shard->GetFrame(frame);
+        if (page->GetPageId() != INVALID_PAGE_ID && page->IsDirty() && page->TryLockFrame()) {
+          batch.emplace_back(static_cast<frame_id_t>(frame), page);
+        }
+      }
+      shard->writes_in_flight_ += batch.size();
+    }
+    /*Foreground threads pinned or evicted the remaining dirty pages in the meantime*/
+    if (batch.empty()) {
+      break;
+    }
+    /*The log flush and the writes run without the shard latch, the batch is in flight at once*/
+    lsn_t max_lsn = INVALID_LSN;
+    for (const auto &locked : batch) {
+      max_lsn = std::max(max_lsn, locked.second->GetLSN());
+    }
+    ForceLog(max_lsn);
+    std::mutex done_latch;
+    std::condition_variable done_cv;
+    size_t in_flight = batch.size();
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &locked : batch) {
+      Page *dirty_page = locked.second;
+      dirty_page->is_dirty_ = false;
+      disk_manager_->WritePageAsync(dirty_page->GetPageId(), dirty_page->GetData(), [&, dirty_page](bool success) {
+        shard->metrics_.write_latency_.Record(std::chrono::steady_clock::now() - start);
+        /*A failed write leaves the page dirty, so it is written again later*/
+        if (!success) {
+          dirty_page->is_dirty_ = true;
+        }
+        std::lock_guard<std::mutex> done_guard(done_latch);
+        if (--in_flight == 0) {
+          done_cv.notify_one();
+        }
+      });
+    }
+    {
+      std::unique_lock<std::mutex> done_lock(done_latch);
+      done_cv.wait(done_lock, [&] { return in_flight == 0; });
+    }
+    /*Unlock the frames and hand them back to the replacer, which may have dropped them while they were locked*/
+    {
+      std::lock_guard<std::mutex> guard(shard->latch_);
+      for (const auto &locked : batch) {
+        locked.second->SetPinState(locked.second->GetPageId(), 0);
+        shard->replacer_->Release(locked.first);
+      }
+      shard->writes_in_flight_ -= batch.size();
+      shard->io_done_cv_.notify_all();
+    }
+    pages_written += batch.size();
+    needed -= batch.size();
+    background_queue_depth_ -= batch.size();
+  }
+  background_queue_depth_ -= needed;
+  background_pages_written_ += pages_written;
+  return pages_written;
+}
+
+}  // namespace bustub
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_metrics.cpp
+//
+// Identification: src/buffer/buffer_pool_metrics.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_metrics.h"
+
+#include <sstream>
+
+namespace bustub {
+
+void BufferPoolMetrics::Add(const BufferPoolShardMetrics &shard_metrics) {
+  fetch_hits_ += shard_metrics.fetch_hits_.load(std::memory_order_relaxed);
+  fetch_misses_ += shard_metrics.fetch_misses_.load(std::memory_order_relaxed);
+  new_pages_ += shard_metrics.new_pages_.load(std::memory_order_relaxed);
+  evictions_ += shard_metrics.evictions_.load(std::memory_order_relaxed);
+  dirty_writebacks_ += shard_metrics.dirty_writebacks_.load(std::memory_order_relaxed);
+  failed_allocations_ += shard_metrics.failed_allocations_.load(std::memory_order_relaxed);
+  read_ahead_pages_ += shard_metrics.read_ahead_pages_.load(std::memory_order_relaxed);
+  read_latency_.Merge(shard_metrics.read_latency_.GetSnapshot());
+  write_latency_.Merge(shard_metrics.write_latency_.GetSnapshot());
+}
+
+std::string BufferPoolMetrics::ToString() const {
+  std::ostringstream os;
+  os << "fetch_hits " << fetch_hits_ << "\n"
+     << "fetch_misses " << fetch_misses_ << "\n"
+     << "hit_ratio " << GetHitRatio() << "\n"
+     << "new_pages " << new_pages_ << "\n"
+     << "evictions " << evictions_ << "\n"
+     << "dirty_writebacks " << dirty_writebacks_ << "\n"
+     << "failed_allocations " << failed_allocations_ << "\n"
+     << "read_ahead_pages " << read_ahead_pages_ << "\n";
+  auto dump_histogram = [&os](const char *name, const LatencyHistogramSnapshot &histogram) {
+    os << name << "_count " << histogram.count_ << "\n"
+       << name << "_mean_ns " << histogram.GetMean() << "\n"
+       << name << "_p50_ns " << histogram.GetPercentile(50) << "\n"
+       << name << "_p99_ns " << histogram.GetPercentile(99) << "\n";
+  };
+  dump_histogram("read", read_latency_);
+  dump_histogram("write", write_latency_);
+  return os.str();
+}
+
+}  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <utility>
+
+#include "common/util/compression_util.h"
+
+namespace bustub {
+
+CompressedPageCache::CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+uint64_t CompressedPageCache::Reserve(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto old_entry = entries_.find(page_id);
+  if (old_entry != entries_.end()) {
+    RemoveEntry(old_entry);
+  }
+  reservations_[page_id] = ++last_reservation_;
+  return last_reservation_;
+}
+
+bool CompressedPageCache::Insert(page_id_t page_id, const char *page_data, uint64_t reservation) {
+  // Compress outside of the latch, into a buffer that only fits pages worth keeping.
+  std::vector<char> data(PAGE_SIZE - PAGE_SIZE / 4);
+  size_t size = CompressionUtil::Compress(page_data, PAGE_SIZE, data.data(), data.size());
+  std::lock_guard<std::mutex> guard(latch_);
+  auto open_reservation = reservations_.find(page_id);
+  if (open_reservation == reservations_.end() || open_reservation->second != reservation) {
+    return false;
+  }
+  reservations_.erase(open_reservation);
+  if (size == 0 || size > capacity_) {
+    stats_.rejections_++;
+    return false;
+  }
+  data.resize(size);
+  data.shrink_to_fit();
+  while (stats_.compressed_bytes_ + size > capacity_) {
+    RemoveEntry(entries_.find(lru_list_.back()));
+    stats_.evictions_++;
+  }
+  lru_list_.push_front(page_id);
+  entries_[page_id] = {std::move(data), lru_list_.begin()};
+  stats_.compressed_bytes_ += size;
+  stats_.num_pages_++;
+  stats_.insertions_++;
+  return true;
+}
+
+bool CompressedPageCache::Lookup(page_id_t page_id, char *page_data) {
+  std::vector<char> data;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    reservations_.erase(page_id);
+    auto entry = entries_.find(page_id);
+    if (entry == entries_.end()) {
+      stats_.misses_++;
+      return false;
+    }
+    // The entry is left with an empty buffer, which RemoveEntry accounts as zero bytes.
+    data.swap(entry->second.data_);
+    stats_.compressed_bytes_ -= data.size();
+    RemoveEntry(entry);
+    stats_.hits_++;
+  }
+  // Decompress outside of the latch. Should the data be damaged, the caller falls back to the copy on disk.
+  return CompressionUtil::Decompress(data.data(), data.size(), page_data, PAGE_SIZE) == PAGE_SIZE;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  reservations_.erase(page_id);
+  auto entry = entries_.find(page_id);
+  if (entry != entries_.end()) {
+    RemoveEntry(entry);
+  }
+}
+
+CompressedPageCacheStats CompressedPageCache::GetStats() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return stats_;
+}
+
+void CompressedPageCache::RemoveEntry(std::unordered_map<page_id_t, Entry>::iterator entry) {
+  stats_.compressed_bytes_ -= entry->second.data_.size();
+  stats_.num_pages_--;
+  lru_list_.erase(entry->second.lru_position_);
+  entries_.erase(entry);
+}
+
+}  // namespace bustub
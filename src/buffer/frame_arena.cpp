@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <cstdint>
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages) : num_frames_(num_frames) {
+  size_t size = num_frames_ * PAGE_SIZE;
+  // A huge page only pays off if the arena spans at least one, and only maps an aligned range.
+  bool align_to_huge_page = huge_pages && size >= HUGE_PAGE_SIZE;
+  // mmap only aligns to the page size of the system, which is smaller than PAGE_SIZE in builds with large pages.
+  size_t alignment = align_to_huge_page ? HUGE_PAGE_SIZE : PAGE_SIZE;
+  mapping_size_ = size + alignment;
+  void *mapping =
+      mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  BUSTUB_ASSERT(mapping != MAP_FAILED, "Cannot map the frame arena.");
+  mapping_ = static_cast<char *>(mapping);
+  auto address = reinterpret_cast<uintptr_t>(mapping_);
+  data_ = reinterpret_cast<char *>((address + alignment - 1) & ~(alignment - 1));
+  if (align_to_huge_page) {
+#ifdef MADV_HUGEPAGE
+    huge_pages_ = madvise(data_, size, MADV_HUGEPAGE) == 0;
+#endif
+  }
+}
+
+FrameArena::~FrameArena() { munmap(mapping_, mapping_size_); }
+
+void FrameArena::Release(size_t first_frame, size_t num_frames) {
+  BUSTUB_ASSERT(first_frame + num_frames <= num_frames_, "Frames out of range.");
+  madvise(GetFrameData(first_frame), num_frames * PAGE_SIZE, MADV_DONTNEED);
+}
+
+}  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period)
+    : k_(k), correlated_period_(correlated_period), frames_(num_pages) {
+  BUSTUB_ASSERT(k_ > 0, "LRU-K needs to remember at least one access.");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+std::set<LRUKReplacer::HistoryKey> *LRUKReplacer::GetEvictableSet(const FrameHistory &frame) {
+  return frame.accesses_.size() >= k_ ? &hot_frames_ : &cold_frames_;
+}
+
+LRUKReplacer::HistoryKey LRUKReplacer::GetKey(const FrameHistory &frame, frame_id_t frame_id) const {
+  return {frame.accesses_.size() >= k_ ? frame.accesses_.front() : frame.last_access_, frame_id};
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // A frame with fewer than k accesses beats every frame with k accesses. Among those the least recently used frame
+  // comes first, among full histories the one whose k-th most recent access is the earliest, which has the largest
+  // backward k-distance.
+  std::set<HistoryKey> *evictable = !cold_frames_.empty() ? &cold_frames_ : &hot_frames_;
+  if (evictable->empty()) {
+    return false;
+  }
+  *frame_id = evictable->begin()->second;
+  evictable->erase(evictable->begin());
+  FrameHistory &victim = frames_[*frame_id];
+  victim.accesses_.clear();
+  victim.placeholder_ = false;
+  victim.evictable_ = false;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Frame id out of range.");
+  FrameHistory &frame = frames_[frame_id];
+  // Pinning a frame that is not in the replacer has no effect; the history is kept for the next unpin.
+  if (frame.evictable_) {
+    GetEvictableSet(frame)->erase(GetKey(frame, frame_id));
+    frame.evictable_ = false;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Frame id out of range.");
+  FrameHistory &frame = frames_[frame_id];
+  // Unpinning a frame that is already in the replacer has no effect.
+  if (frame.evictable_) {
+    return;
+  }
+  if (frame.placeholder_) {
+    frame.accesses_.clear();
+    frame.placeholder_ = false;
+  }
+  size_t now = current_timestamp_++;
+  // the accesses of other frames since the previous access of this one tell whether it continues a burst
+  if (frame.accesses_.empty() || now - frame.last_access_ > correlated_period_) {
+    frame.accesses_.push_back(now);
+    if (frame.accesses_.size() > k_) {
+      frame.accesses_.pop_front();
+    }
+  }
+  frame.last_access_ = now;
+  GetEvictableSet(frame)->insert(GetKey(frame, frame_id));
+  frame.evictable_ = true;
+}
+
+void LRUKReplacer::Release(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Frame id out of range.");
+  FrameHistory &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  // A frame without history needs a position in the order. It gets a placeholder, which its first use replaces.
+  if (frame.accesses_.empty()) {
+    frame.last_access_ = current_timestamp_++;
+    frame.accesses_.push_back(frame.last_access_);
+    frame.placeholder_ = true;
+  }
+  GetEvictableSet(frame)->insert(GetKey(frame, frame_id));
+  frame.evictable_ = true;
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Frame id out of range.");
+  FrameHistory &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    GetEvictableSet(frame)->erase(GetKey(frame, frame_id));
+    frame.evictable_ = false;
+  }
+  // The accesses were those of the page the frame held, the next page starts without history.
+  frame.accesses_.clear();
+  frame.placeholder_ = false;
+}
+
+size_t LRUKReplacer::Size() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return cold_frames_.size() + hot_frames_.size();
+}
+
+}  // namespace bustub
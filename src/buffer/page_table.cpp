@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  // Keep the load factor at or below one half, so probe sequences stay short.
+  shift_ = 1;
+  while ((static_cast<size_t>(1) << shift_) < 2 * num_frames) {
+    shift_++;
+  }
+  mask_ = (static_cast<size_t>(1) << shift_) - 1;
+  slots_ = std::vector<std::atomic<uint64_t>>(mask_ + 1);
+  for (auto &slot : slots_) {
+    slot.store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+size_t PageTable::HomeSlot(page_id_t page_id) const {
+  // Fibonacci hashing spreads the strided page ids of a shard over the whole table.
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                             (64 - shift_));
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  size_t slot = HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask_; probes++) {
+    uint64_t entry = slots_[slot].load(std::memory_order_acquire);
+    if (entry == EMPTY_SLOT) {
+      return false;
+    }
+    if (UnpackPageId(entry) == page_id) {
+      *frame_id = UnpackFrameId(entry);
+      return true;
+    }
+    slot = (slot + 1) & mask_;
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  size_t slot = HomeSlot(page_id);
+  while (true) {
+    uint64_t entry = slots_[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY_SLOT || UnpackPageId(entry) == page_id) {
+      slots_[slot].store(PackEntry(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    slot = (slot + 1) & mask_;
+  }
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+  size_t hole = HomeSlot(page_id);
+  while (true) {
+    uint64_t entry = slots_[hole].load(std::memory_order_relaxed);
+    if (entry == EMPTY_SLOT) {
+      return false;
+    }
+    if (UnpackPageId(entry) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+  // Move every later entry of the probe sequence that could not be found past the hole any more into the hole.
+  size_t slot = hole;
+  while (true) {
+    slot = (slot + 1) & mask_;
+    uint64_t entry = slots_[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = HomeSlot(UnpackPageId(entry));
+    bool reachable = hole < slot ? (home > hole && home <= slot) : (home > hole || home <= slot);
+    if (reachable) {
+      continue;
+    }
+    slots_[hole].store(entry, std::memory_order_release);
+    hole = slot;
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util.cpp
+//
+// Identification: src/common/util/compression_util.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <array>
+#include <cstring>
+
+#include "common/util/compression_util.h"
+
+namespace bustub {
+
+namespace {
+
+/** log2 of the number of entries of the match finder's hash table. */
+constexpr size_t HASH_BITS = 12;
+
+inline uint32_t Read32(const char *src) {
+  uint32_t value;
+  memcpy(&value, src, sizeof(value));
+  return value;
+}
+
+inline size_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Appends the extra bytes of a length whose nibble was 15. */
+inline bool WriteLength(size_t length, char *dst, size_t capacity, size_t *out) {
+  while (length >= 255) {
+    if (*out >= capacity) {
+      return false;
+    }
+    dst[(*out)++] = static_cast<char>(255);
+    length -= 255;
+  }
+  if (*out >= capacity) {
+    return false;
+  }
+  dst[(*out)++] = static_cast<char>(length);
+  return true;
+}
+
+/** Reads the extra bytes of a length whose nibble was 15 and adds them to length. */
+inline bool ReadLength(const unsigned char *src, size_t size, size_t *in, size_t *length) {
+  while (true) {
+    if (*in >= size) {
+      return false;
+    }
+    unsigned char byte = src[(*in)++];
+    *length += byte;
+    if (byte != 255) {
+      return true;
+    }
+  }
+}
+
+/** Appends a sequence of literals followed by a match; a match_length of 0 ends the data. */
+bool WriteSequence(const char *literals, size_t num_literals, size_t offset, size_t match_length, char *dst,
+                   size_t capacity, size_t *out) {
+  if (*out >= capacity) {
+    return false;
+  }
+  size_t match_code = match_length == 0 ? 0 : match_length - CompressionUtil::MIN_MATCH;
+  size_t token = *out;
+  dst[(*out)++] = static_cast<char>((num_literals < 15 ? num_literals : 15) << 4 | (match_code < 15 ? match_code : 15));
+  if (num_literals >= 15 && !WriteLength(num_literals - 15, dst, capacity, out)) {
+    return false;
+  }
+  if (*out + num_literals > capacity) {
+    return false;
+  }
+  memcpy(dst + *out, literals, num_literals);
+  *out += num_literals;
+  if (match_length == 0) {
+    // The token of the last sequence must not claim a match.
+    dst[token] = static_cast<char>(dst[token] & 0xF0);
+    return true;
+  }
+  if (*out + 2 > capacity) {
+    return false;
+  }
+  dst[(*out)++] = static_cast<char>(offset & 0xFF);
+  dst[(*out)++] = static_cast<char>(offset >> 8);
+  return match_code < 15 || WriteLength(match_code - 15, dst, capacity, out);
+}
+
+}  // namespace
+
+size_t CompressionUtil::Compress(const char *src, size_t size, char *dst, size_t capacity) {
+  // Positions are stored plus one, so that zero marks an empty entry.
+  std::array<uint32_t, static_cast<size_t>(1) << HASH_BITS> table{};
+  size_t out = 0;
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= size) {
+    uint32_t sequence = Read32(src + pos);
+    size_t slot = Hash(sequence);
+    size_t candidate = table[slot];
+    table[slot] = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || Read32(src + candidate - 1) != sequence) {
+      pos++;
+      continue;
+    }
+    size_t match = candidate - 1;
+    size_t length = MIN_MATCH;
+    while (pos + length < size && src[match + length] == src[pos + length]) {
+      length++;
+    }
+    if (!WriteSequence(src + anchor, pos - anchor, pos - match, length, dst, capacity, &out)) {
+      return 0;
+    }
+    pos += length;
+    anchor = pos;
+  }
+  if (!WriteSequence(src + anchor, size - anchor, 0, 0, dst, capacity, &out)) {
+    return 0;
+  }
+  return out;
+}
+
+size_t CompressionUtil::Decompress(const char *src, size_t size, char *dst, size_t capacity) {
+  const auto *in_bytes = reinterpret_cast<const unsigned char *>(src);
+  size_t in = 0;
+  size_t out = 0;
+  while (in < size) {
+    unsigned char token = in_bytes[in++];
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !ReadLength(in_bytes, size, &in, &num_literals)) {
+      return 0;
+    }
+    if (in + num_literals > size || out + num_literals > capacity) {
+      return 0;
+    }
+    memcpy(dst + out, src + in, num_literals);
+    in += num_literals;
+    out += num_literals;
+    if (in == size) {
+      break;
+    }
+    if (in + 2 > size) {
+      return 0;
+    }
+    size_t offset = in_bytes[in] | static_cast<size_t>(in_bytes[in + 1]) << 8;
+    in += 2;
+    size_t match_length = (token & 0x0F) + MIN_MATCH;
+    if ((token & 0x0F) == 15 && !ReadLength(in_bytes, size, &in, &match_length)) {
+      return 0;
+    }
+    if (offset == 0 || offset > out || out + match_length > capacity) {
+      return 0;
+    }
+    // Byte by byte, since a match may overlap the bytes it produces.
+    for (size_t i = 0; i < match_length; ++i) {
+      dst[out + i] = dst[out - offset + i];
+    }
+    out += match_length;
+  }
+  return out;
+}
+
+}  // namespace bustub
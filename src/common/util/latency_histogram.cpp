@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.cpp
+//
+// Identification: src/common/util/latency_histogram.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/latency_histogram.h"
+
+namespace bustub {
+
+/** @return the bucket that counts a latency */
+static size_t GetBucket(uint64_t nanos) {
+  if (nanos < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+    return nanos;
+  }
+  // The highest set bit picks the power of two, the bits below it the sub-bucket.
+  auto top_bit = static_cast<size_t>(63 - __builtin_clzll(nanos));
+  if (top_bit >= LATENCY_HISTOGRAM_MAX_BITS) {
+    return LATENCY_HISTOGRAM_BUCKETS - 1;
+  }
+  size_t shift = top_bit - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+  return (shift + 1) * LATENCY_HISTOGRAM_SUB_BUCKETS + (nanos >> shift) - LATENCY_HISTOGRAM_SUB_BUCKETS;
+}
+
+/** @return the end of a bucket, the smallest latency above it */
+static uint64_t GetBucketEnd(size_t bucket) {
+  if (bucket < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+    return bucket + 1;
+  }
+  size_t shift = bucket / LATENCY_HISTOGRAM_SUB_BUCKETS - 1;
+  return (LATENCY_HISTOGRAM_SUB_BUCKETS + bucket % LATENCY_HISTOGRAM_SUB_BUCKETS + 1) << shift;
+}
+
+uint64_t LatencyHistogramSnapshot::GetPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  // The rank of the percentile, counted from 1.
+  auto rank = static_cast<uint64_t>(percentile / 100 * count_ + 0.5);
+  rank = rank == 0 ? 1 : rank;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return GetBucketEnd(i);
+    }
+  }
+  return GetBucketEnd(LATENCY_HISTOGRAM_BUCKETS - 1);
+}
+
+void LatencyHistogramSnapshot::Merge(const LatencyHistogramSnapshot &other) {
+  for (size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  total_nanos_ += other.total_nanos_;
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds latency) {
+  auto nanos = static_cast<uint64_t>(latency.count() > 0 ? latency.count() : 0);
+  buckets_[GetBucket(nanos)].fetch_add(1, std::memory_order_relaxed);
+  total_nanos_.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+LatencyHistogramSnapshot LatencyHistogram::GetSnapshot() const {
+  LatencyHistogramSnapshot snapshot;
+  for (size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+    snapshot.count_ += snapshot.buckets_[i];
+  }
+  snapshot.total_nanos_ = total_nanos_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+}  // namespace bustub
@@ -30,7 +30,8 @@ Transaction *TransactionManager::Begin(Transaction *txn) {
   }
 
   if (enable_logging) {
-    // TODO(student): Add logging here.
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
   }
 
   txn_map[txn->GetTransactionId()] = txn;
@@ -54,7 +55,11 @@ void TransactionManager::Commit(Transaction *txn) {
   write_set->clear();
 
   if (enable_logging) {
-    // TODO(student): add logging here
+    // The transaction is durable once its commit record is, and it waits for that before releasing its locks. The
+    // flush thread writes the commit records of all the transactions waiting here at once.
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+    log_manager_->Flush(txn->GetPrevLSN());
   }
 
   // Release all the locks.
@@ -84,7 +89,9 @@ void TransactionManager::Abort(Transaction *txn) {
   write_set->clear();
 
   if (enable_logging) {
-    // TODO(student): add logging here
+    // The rollback is logged already, so the abort record need not wait for the log.
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
   }
 
   // Release all the locks.
@@ -29,8 +29,6 @@ HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
 		num_buckets_ = num_buckets;
 		header_page_id_ = INVALID_PAGE_ID;
-		/*Get header page*/
-		header_page_ = reinterpret_cast<HashTableHeaderPage *>(buffer_pool_manager_->NewPage(&header_page_id_,nullptr));
 		/*Each block_page can store BLOCK_ARRAY_SIZE of <key,value> pairs. */
 		num_slots_ = num_buckets/BLOCK_ARRAY_SIZE;
 		/*If sum buckets are leftover after all slots are filled then add one more slot.
@@ -38,12 +36,18 @@ HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager
 		if(num_buckets%BLOCK_ARRAY_SIZE){
 			num_slots_++;
 		}
+		/*Header and block pages come from one extent, so they sit next to each other on disk*/
+		PageExtent extent(num_slots_ + 1);
+		/*Get header page*/
+		header_page_ = reinterpret_cast<HashTableHeaderPage *>(buffer_pool_manager_->NewPageInExtent(&header_page_id_,&extent)->GetData());
 		/*Fill up the hash table with block_pages as per the slots */
 		for(size_t i = 0;i < num_slots_;i++){
 			page_id_t block_page_id = INVALID_PAGE_ID;
-			auto block_page = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->NewPage(&block_page_id,nullptr));
+			auto block_page = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->NewPageInExtent(&block_page_id,&extent)->GetData());
 			block_page->SetPageId(block_page_id);
 			header_page_->AddBlockPageId(block_page_id);
+			/*Only the header page stays pinned, block pages are fetched again on each access*/
+			buffer_pool_manager_->UnpinPage(block_page_id, true);
 		}
 	}
 
@@ -55,57 +59,61 @@ bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
 	size_t hash_value = hash_fn_.GetHash(key);
 	/*Table slot index determines the block page where key is located */
 	size_t table_slot_index = hash_value%num_slots_;
-	page_id_t block_page_id = header_page_->GetBlockPageId(table_slot_index);
-	auto block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->FetchPage(block_page_id,nullptr));
 	/*Page slot index determines the slot in page the <key,value> pair should go into*/
-	size_t page_slot_index = hash_value%BLOCK_ARRAY_SIZE;
-	size_t page_slot_counter = 0;
-	size_t table_slot_counter = 0;
+	slot_offset_t page_slot_index = hash_value%BLOCK_ARRAY_SIZE;
 	std::vector<ValueType> result_container;
-	while(true){
-		/*Check if slot has never been occupied*/
-		if(!block_page->IsOccupied(page_slot_index)){
-			break;
+	for(size_t table_slot_counter = 0;table_slot_counter < num_slots_;table_slot_counter++){
+		page_id_t block_page_id = header_page_->GetBlockPageId(table_slot_index);
+		Page *page = buffer_pool_manager_->FetchPage(block_page_id,nullptr);
+		auto block_page = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+		/*Scan the block page without latching it and keep the matches only if no writer changed it meanwhile*/
+		std::vector<ValueType> block_result;
+		uint64_t version;
+		bool probe_done = false;
+		bool optimistic = page->TryOptimisticRLatch(&version);
+		if(optimistic){
+			probe_done = ScanBlock(block_page, page_slot_index, key, &block_result);
+			optimistic = page->ValidateOptimisticRLatch(version);
 		}
-		else if(block_page->IsReadable(page_slot_index)){
-			if(!comparator_(block_page->KeyAt(page_slot_index),key)){
-				result_container.push_back(block_page->ValueAt(page_slot_index));
-			}
-		}
-		/*If key is not found tin that block page, keep in next block page*/
-		page_slot_counter++;
-		if(page_slot_counter < BLOCK_ARRAY_SIZE){
-			page_slot_index = (page_slot_index+1)%BLOCK_ARRAY_SIZE;
-			continue;
+		if(!optimistic){
+			block_result.clear();
+			page->RLatch();
+			probe_done = ScanBlock(block_page, page_slot_index, key, &block_result);
+			page->RUnlatch();
 		}
-		/*If whole block page does not have key, check for it in next available block page*/
-		else{
-			table_slot_counter++;
-			if(table_slot_counter < num_slots_){
-				/*Get the next block_page and unpin the current block_page*/
-				page_slot_index = 0;
-				page_slot_counter = 0;
-				table_slot_index = (table_slot_index+1)%num_slots_;
-				buffer_pool_manager_->UnpinPage(block_page_id,false);
-				block_page_id = header_page_->GetBlockPageId(table_slot_index);
-				block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->FetchPage(block_page_id,nullptr));
-				continue;
-			}
-			else{
-				break;
-			}
+		buffer_pool_manager_->UnpinPage(block_page_id,false);
+		result_container.insert(result_container.end(), block_result.begin(), block_result.end());
+		if(probe_done){
+			break;
 		}
+		/*If the probe did not end in this block page, continue with the next block page*/
+		page_slot_index = 0;
+		table_slot_index = (table_slot_index+1)%num_slots_;
 	}
-	if(result_container.size() == 0){
-		result = nullptr;
+	if(result_container.empty()){
 		return false;
 	}
-	else{
-		*result = result_container;
-		return true;
+	*result = result_container;
+	return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::ScanBlock(HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t page_slot_index, const KeyType &key,
+                                std::vector<ValueType> *result) {
+	/*Probe every slot of the block page once, wrapping around like Insert does*/
+	for(size_t page_slot_counter = 0;page_slot_counter < BLOCK_ARRAY_SIZE;page_slot_counter++){
+		/*Check if slot has never been occupied*/
+		if(!block_page->IsOccupied(page_slot_index)){
+			return true;
+		}
+		if(block_page->IsReadable(page_slot_index) && !comparator_(block_page->KeyAt(page_slot_index),key)){
+			result->push_back(block_page->ValueAt(page_slot_index));
+		}
+		page_slot_index = (page_slot_index+1)%BLOCK_ARRAY_SIZE;
 	}
 	return false;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -115,21 +123,27 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
 	/*Table slot index determines the block page the <key,value> pair should go into */
 	size_t table_slot_index = hash_value%num_slots_;
 	page_id_t block_page_id = header_page_->GetBlockPageId(table_slot_index);
-	auto block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->FetchPage(block_page_id,nullptr));
+	Page *page = buffer_pool_manager_->FetchPage(block_page_id,nullptr);
+	auto block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
 	/*Page slot index determines the slot in page the <key,value> pair should go into*/
 	size_t page_slot_index = hash_value%BLOCK_ARRAY_SIZE;
 	size_t page_slot_counter = 0;
 	size_t table_slot_counter = 0;
+	/*Hold the write latch across the whole probe of a block page, so the duplicate check and the insertion see the same
+	 * slots. The write latch also bumps the page version for optimistic readers.*/
+	page->WLatch();
 	while(true){
 		/*If able to insert successfully, return true*/
 		if(block_page->Insert(page_slot_index,key,value)){
 			/*If insertion is successful, unpin the page*/
+			page->WUnlatch();
 			buffer_pool_manager_->UnpinPage(block_page_id, true);
 			return true;
 		}
 		/*If <k,v> pair already exists, return false since duplicates are not allowed.*/
 		else if(!(comparator_(block_page->KeyAt(page_slot_index),key)) && block_page->ValueAt(page_slot_index) == value){
 			/*If insertion is not possible, unpin the page*/
+			page->WUnlatch();
 			buffer_pool_manager_->UnpinPage(block_page_id,false);
 			return false;
 		}
@@ -142,14 +156,17 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
 		/*If whole block page is full, check for next available block page*/
 		else{
 			table_slot_counter++;
+			page->WUnlatch();
+			buffer_pool_manager_->UnpinPage(block_page_id,false);
 			if(table_slot_counter < num_slots_){
-				/*Get the next block_page and unpin the current block_page*/
+				/*Get the next block_page, the current block_page is unpinned already*/
 				page_slot_index = 0;
 				page_slot_counter = 0;
 				table_slot_index = (table_slot_index+1)%num_slots_;
-				buffer_pool_manager_->UnpinPage(block_page_id,false);
 				block_page_id = header_page_->GetBlockPageId(table_slot_index);
-				block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->FetchPage(block_page_id,nullptr));
+				page = buffer_pool_manager_->FetchPage(block_page_id,nullptr);
+				block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+				page->WLatch();
 				continue;
 			}
 			else{
@@ -171,14 +188,18 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
 	/*Table slot index determines the block page where <key,value> is located */
 	size_t table_slot_index = hash_value%num_slots_;
 	page_id_t block_page_id = header_page_->GetBlockPageId(table_slot_index);
-	auto block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->FetchPage(block_page_id,nullptr));
+	Page *page = buffer_pool_manager_->FetchPage(block_page_id,nullptr);
+	auto block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
 	/*Page slot index determines the slot in page the <key,value> pair should go into*/
 	size_t page_slot_index = hash_value%BLOCK_ARRAY_SIZE;
 	size_t page_slot_counter = 0;
 	size_t table_slot_counter = 0;
+	/*Hold the write latch across the whole probe of a block page, so the slot that matched is the slot removed*/
+	page->WLatch();
   	while(true){
 		/*Check if page slot was ever occupied, if not then return false*/
 		if(!block_page->IsOccupied(page_slot_index)){
+			page->WUnlatch();
 			buffer_pool_manager_->UnpinPage(block_page_id,false);
 			return false;
 		}
@@ -186,7 +207,8 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
 		else if(block_page->IsReadable(page_slot_index)){
 			if(!(comparator_(block_page->KeyAt(page_slot_index),key)) && block_page->ValueAt(page_slot_index) == value){
 				block_page->Remove(page_slot_index);
-				buffer_pool_manager_->UnpinPage(block_page_id,false);
+				page->WUnlatch();
+				buffer_pool_manager_->UnpinPage(block_page_id,true);
 				return true;
 			}
 		}
@@ -199,14 +221,17 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
 		/*If <k,v> is not in whole block page, check for next available block page*/
 		else{
 			table_slot_counter++;
+			page->WUnlatch();
+			buffer_pool_manager_->UnpinPage(block_page_id,false);
 			if(table_slot_counter < num_slots_){
-				/*Get the next block_page and unpin the current block_page*/
+				/*Get the next block_page, the current block_page is unpinned already*/
 				page_slot_index = 0;
 				page_slot_counter = 0;
 				table_slot_index = (table_slot_index+1)%num_slots_;
-				buffer_pool_manager_->UnpinPage(block_page_id,false);
 				block_page_id = header_page_->GetBlockPageId(table_slot_index);
-				block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->FetchPage(block_page_id,nullptr));
+				page = buffer_pool_manager_->FetchPage(block_page_id,nullptr);
+				block_page =  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+				page->WLatch();
 				continue;
 			}
 			else{
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy lets a bulk reader such as a sequential scan recycle a small private ring of frames instead of
+ * pulling every page it reads through the replacer. Once the ring is full, a miss reuses the ring frame the scan has
+ * released longest ago, so a scan over a table much larger than the buffer pool only ever occupies ring_size frames
+ * and cannot push out the working set of point lookups.
+ *
+ * A strategy belongs to a single scan. The buffer pool's read-ahead thread may load pages through it concurrently with
+ * the scan, so destroying a strategy waits until all read-ahead requests that use it have completed. The strategy also
+ * remembers how far ahead of the scan pages were already requested, so each page of the scan is read ahead only once.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+ public:
+  /**
+   * Creates a new buffer ring.
+   * @param ring_size the maximum number of frames the ring may occupy
+   */
+  explicit BufferAccessStrategy(size_t ring_size = BUFFER_RING_SIZE) : ring_size_(ring_size) {
+    BUSTUB_ASSERT(ring_size_ > 0, "A buffer ring needs at least one frame.");
+    ring_.reserve(ring_size_);
+  }
+
+  ~BufferAccessStrategy() {
+    std::unique_lock<std::mutex> latch(latch_);
+    read_ahead_done_.wait(latch, [this] { return pending_read_ahead_ == 0; });
+  }
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /** @return the maximum number of frames in the ring */
+  size_t GetRingSize() const { return ring_size_; }
+
+ private:
+  /** A frame that was filled through this ring. */
+  struct RingSlot {
+    /** Index of the buffer pool shard that owns the frame. */
+    size_t shard_;
+    /** Shard local id of the frame. */
+    frame_id_t frame_id_;
+    /** The page the ring loaded into the frame; if the frame now holds another page it was stolen. */
+    page_id_t page_id_;
+  };
+
+  /** Maximum number of frames in the ring. */
+  size_t ring_size_;
+  /** Frames of the ring, in the order they are recycled. */
+  std::vector<RingSlot> ring_;
+  /** Position of the next slot to recycle. */
+  size_t next_slot_{0};
+  /** Number of queued or running read-ahead requests that load pages through this ring. */
+  size_t pending_read_ahead_{0};
+  /** Position of the page the scan reads ahead from, counted along the page chain. */
+  size_t read_ahead_position_{0};
+  /** Position of the first page after the ones that were already read ahead. */
+  size_t read_ahead_horizon_{0};
+  /** The page at the horizon, INVALID_PAGE_ID if the chain ended or the last request stopped early. */
+  page_id_t read_ahead_next_{INVALID_PAGE_ID};
+  /** Protects the ring and the read-ahead state. */
+  std::mutex latch_;
+  /** Signalled whenever a read-ahead request of this ring completes. */
+  std::condition_variable read_ahead_done_;
+};
+
+}  // namespace bustub
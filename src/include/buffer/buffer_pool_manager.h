@@ -12,32 +12,68 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_metrics.h"
 #include "buffer/clock_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/page_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/** Progress report of the background writer. */
+struct BackgroundWriterStats {
+  /** Total number of pages the background writer has written back. */
+  size_t pages_written_;
+  /** Pages written per second during the last round. */
+  double pages_per_second_;
+  /** Number of dirty evictable pages the current round still has to write to reach the clean target. */
+  size_t queue_depth_;
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * The pool is partitioned into shards. A page id always maps to the same shard, and every shard owns a disjoint slice
+ * of the frames together with its own page table, free list, replacer and latch. Operations on pages that live in
+ * different shards therefore never contend with each other.
+ *
+ * Fetching and unpinning a resident page takes no latch at all: the page table is searched without a latch, and the
+ * pin count is changed by an atomic operation that only succeeds while the frame still holds the page (see
+ * Page::TryPin). Everything that changes which page a frame holds runs under the shard latch and first locks the
+ * frame with Page::TryLockFrame, which fails for pinned frames.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
+  /** Returns the id of the page that follows the given (pinned) page in a linked page chain. */
+  using next_page_fn = page_id_t (*)(Page *page);
 
   /**
    * Creates a new BufferPoolManager.
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param num_shards the number of independently latched partitions the frames are split into
+   * @param replacer_type the replacement policy used to pick victims inside every shard
+   * @param max_pool_size the size the pool can grow to with Resize, 0 to keep it at pool_size
    */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                    size_t num_shards = 1, ReplacerType replacer_type = ReplacerType::CLOCK, size_t max_pool_size = 0);
 
   /**
    * Destroys an existing BufferPoolManager.
@@ -52,6 +88,17 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetches a page on behalf of a bulk reader. Hits behave exactly like FetchPage, but misses are served from the
+   * strategy's ring of frames, so the reader cannot flood the buffer pool.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer ring of the reader, nullptr behaves like FetchPage
+   * @return the requested page, or nullptr if no frame was available
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPageImpl(page_id, strategy);
+  }
+
   /** Grading function. Do not modify! */
   bool UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -91,13 +138,319 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
+  /**
+   * Creates a new page in the buffer pool, taking its id from an extent instead of allocating a page on its own. A new
+   * extent is reserved once the current one is used up.
+   * @param[out] page_id id of created page
+   * @param extent the extent of the table or index the page belongs to
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageInExtent(page_id_t *page_id, PageExtent *extent) { return NewPageImpl(page_id, extent); }
+
+  /**
+   * Asynchronously loads the next pages of a linked page chain into the buffer pool. A background thread walks up to
+   * GetReadAheadDepth() pages, starting at page_id and following next_page_fn, reads the ones that are missing and
+   * leaves them unpinned. Read-ahead does not count as a fetch. Requests are dropped when the read-ahead queue is full.
+   *
+   * With a strategy, the calls are the steps of one scan: page_id is the page after the one the scan just moved to.
+   * Only the pages beyond what earlier calls already requested are walked, once the scan used up half of them.
+   * @param page_id id of the first page to load, INVALID_PAGE_ID is ignored
+   * @param next_page_fn returns the id of the page after a loaded page, called with the page read-latched
+   * @param strategy buffer ring of the scan to load the pages into, nullptr to use the regular free list and replacer
+   */
+  void ReadAhead(page_id_t page_id, next_page_fn next_page_fn, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Sets how many pages ReadAhead loads per request.
+   * @param depth number of pages, 0 disables read-ahead
+   */
+  void SetReadAheadDepth(size_t depth) { read_ahead_depth_ = depth; }
+
+  /** @return the number of pages ReadAhead loads per request */
+  size_t GetReadAheadDepth() { return read_ahead_depth_; }
+
+  /**
+   * Starts the background writer. Every interval, or as soon as an eviction had to write back a dirty victim, the
+   * writer cleans dirty unpinned pages of every shard until at least clean_target of the shard's evictable frames
+   * (free frames and unpinned pages) are clean. Foreground evictions then rarely pay for a write.
+   * @param clean_target fraction of evictable frames to keep clean, between 0 and 1
+   * @param interval time between two rounds of the writer
+   */
+  void RunBackgroundWriter(double clean_target, std::chrono::milliseconds interval);
+
+  /**
+   * Stops and joins the background writer.
+   */
+  void StopBackgroundWriter();
+
+  /** @return the progress of the background writer */
+  BackgroundWriterStats GetBackgroundWriterStats();
+
+  /** @return the counters of all shards added up; GetMetrics().ToString() dumps them as text */
+  BufferPoolMetrics GetMetrics();
+
+  /**
+   * @param shard_index index of the shard, smaller than GetNumShards()
+   * @return the counters of a single shard
+   */
+  BufferPoolMetrics GetShardMetrics(size_t shard_index);
+
+  /**
+   * Grows or shrinks the buffer pool while it is in use. Every shard gains or loses whole chunks of
+   * BUFFER_POOL_CHUNK_SIZE frames: growing adds chunks until the pool holds at least pool_size frames or reached its
+   * maximum size, shrinking releases chunks as long as the pool stays at or above pool_size. A chunk is released by
+   * writing back and evicting its pages; a chunk with a pinned page is skipped, so a shrink that stops short can simply
+   * be retried later. The frames allocated at construction are never released.
+   * @param pool_size the requested number of frames
+   * @return the number of frames after resizing
+   */
+  size_t Resize(size_t pool_size);
+
+  /**
+   * Enables warm restarts. If the snapshot file exists, the pages it lists are loaded into free frames, hottest pages
+   * first, and left unpinned; they are read in page id order with vectored reads spread over WARM_RESTART_THREADS
+   * threads. From then on the resident pages are saved to the file by SaveWarmSnapshot and when the buffer pool is
+   * destroyed. Call this before the buffer pool serves requests, as it holds every shard latch while loading.
+   * @param snapshot_file the file the snapshot is read from and saved to
+   * @return the number of pages that were loaded
+   */
+  size_t EnableWarmRestart(const std::string &snapshot_file);
+
+  /**
+   * Saves the ids of the resident pages with their hotness rank to the snapshot file given to EnableWarmRestart.
+   * Does nothing if warm restarts are not enabled.
+   */
+  void SaveWarmSnapshot();
+
+  /**
+   * Enables the compressed second tier: pages the buffer pool evicts are kept compressed in memory, so fetching them
+   * again costs a decompression instead of a disk read. Call this before the buffer pool serves requests.
+   * @param capacity maximum number of bytes the compressed pages may take
+   */
+  void EnableCompressedCache(size_t capacity);
+
+  /** @return the counters of the compressed second tier, all zero if it is not enabled */
+  CompressedPageCacheStats GetCompressedCacheStats();
+
+  /**
+   * @return pointer to the frames allocated at construction; frames added by Resize live elsewhere. The data of the
+   * frames is PAGE_SIZE aligned, but not contiguous.
+   */
   Page *GetPages() { return pages_; }
 
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /** @return number of shards the buffer pool is partitioned into */
+  size_t GetNumShards() { return num_shards_; }
+
+  /** @return the replacement policy of the buffer pool */
+  ReplacerType GetReplacerType() { return replacer_type_; }
+
  protected:
+  /**
+   * A shard owns a slice of pages_ and the frames it gained through Resize. Frame ids stored in the page table, the
+   * free list and the replacer are local to the shard: the first initial_frames_ ids are the slice of pages_, the
+   * following ids are the chunks that were added.
+   */
+  struct alignas(64) BufferPoolShard {
+    /** Pointer to the first frame owned by this shard. */
+    Page *pages_{nullptr};
+    /** Number of frames the shard got at construction. */
+    size_t initial_frames_{0};
+    /**
+     * Address space reserved for the chunks added by Resize, nullptr if the shard cannot grow. It stays mapped until
+     * the pool is destroyed, so a lock-free lookup may still read the frames of a released chunk; they look empty.
+     */
+    Page *chunk_pages_{nullptr};
+    /** Number of frames owned by this shard. Only changes under both the resize latch and the shard latch. */
+    size_t num_frames_{0};
+    /** Number of frames the shard can grow to. */
+    size_t max_frames_{0};
+    /** Data of the frames of this shard, room for max_frames_ frames is reserved. */
+    FrameArena *arena_{nullptr};
+    /** Page table for keeping track of the pages resident in this shard. */
+    PageTable *page_table_{nullptr};
+    /**
+     * Replacer to find unpinned frames of this shard for replacement. Since pins and unpins do not take the shard
+     * latch, a frame can still be in the replacer for a moment after it was pinned; victims are locked before use.
+     */
+    Replacer *replacer_{nullptr};
+    /** List of free frames of this shard. */
+    std::list<frame_id_t> free_list_;
+    /** Serializes the changes to the page table and free list, and every change of the page held by a frame. */
+    std::mutex latch_;
+    /**
+     * Number of frames locked for a write back that runs without the latch. Together with the frames the read-ahead
+     * thread locked for reading, these are the frames that can be seen locked under the latch. Protected by the latch.
+     */
+    size_t writes_in_flight_{0};
+    /** Signalled under the latch when frames locked for I/O are unlocked. */
+    std::condition_variable io_done_cv_;
+    /** Counters of this shard. */
+    BufferPoolShardMetrics metrics_;
+
+    /** @return the frame with the given shard local id */
+    inline Page *GetFrame(frame_id_t frame_id) {
+      auto frame = static_cast<size_t>(frame_id);
+      return frame < initial_frames_ ? &pages_[frame] : &chunk_pages_[frame - initial_frames_];
+    }
+  };
+
+  /**
+   * Creates a replacer of the configured policy.
+   * @param num_frames the number of frames the replacer has to track
+   * @return the new replacer, owned by the caller
+   */
+  Replacer *CreateReplacer(size_t num_frames);
+
+  /** A queued read-ahead request. */
+  struct ReadAheadRequest {
+    page_id_t page_id_;
+    size_t depth_;
+    next_page_fn next_page_fn_;
+    BufferAccessStrategy *strategy_;
+    /** Position of page_id_ in the scan of the strategy. */
+    size_t position_;
+  };
+
+  /** A copy of a clean victim, on its way to the compressed cache. */
+  struct EvictedPage {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** Reservation of the page in the compressed cache. */
+    uint64_t reservation_{0};
+    std::vector<char> data_;
+  };
+
+  /** A frame the read-ahead thread locked to read a page into. */
+  struct ReadAheadLoad {
+    BufferPoolShard *shard_;
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    bool success_;
+  };
+
+  /** An entry of a warm snapshot file. Rank 0 are the most accessed pages, pages accessed as often share a rank. */
+  struct WarmSnapshotEntry {
+    page_id_t page_id_;
+    uint32_t rank_;
+  };
+
+  /** Marks a warm snapshot file, followed by the number of entries and the entries ordered by rank. */
+  static constexpr uint32_t WARM_SNAPSHOT_MAGIC = 0x4D524157;
+
+  /** Maximum number of queued read-ahead requests. */
+  static constexpr size_t READ_AHEAD_QUEUE_SIZE = 64;
+
+  /** Maximum number of pages the background writer has in flight at once per shard latch hold. */
+  static constexpr size_t BACKGROUND_WRITE_BATCH = 8;
+
+  /** Body of the read-ahead thread: serves queued requests until StopReadAhead is called. */
+  void RunReadAhead();
+
+  /** Loads the pages of a single read-ahead request. */
+  void ProcessReadAhead(const ReadAheadRequest &request);
+
+  /**
+   * Reads the id of the page after a resident page. The page is pinned only for the call of next_page_fn, which is
+   * neither counted as a fetch nor reported to the replacer.
+   * @param page_id id of the page
+   * @param next_page_fn returns the id of the page after the page
+   * @param[out] next_page_id the id of the next page
+   * @return false if the page is not resident
+   */
+  bool PeekNextPageId(page_id_t page_id, next_page_fn next_page_fn, page_id_t *next_page_id);
+
+  /**
+   * Finds a frame for a page that is read ahead, enters the page into the page table and leaves its frame locked
+   * until ReadLockedFrames has read it.
+   * @param page_id id of the page
+   * @param strategy buffer ring to take the frame from, nullptr for the free list and replacer
+   * @param[out] load the locked frame
+   * @return false if the page is resident already or there is no frame
+   */
+  bool LockFrameForRead(page_id_t page_id, BufferAccessStrategy *strategy, ReadAheadLoad *load);
+
+  /**
+   * Reads the pages of frames locked by LockFrameForRead, all of them in flight at once, and unlocks the frames. A
+   * frame whose read failed goes back to the free list.
+   * @param loads the locked frames
+   */
+  void ReadLockedFrames(std::vector<ReadAheadLoad> *loads);
+
+  /** Stops and joins the read-ahead thread, dropping all queued requests. */
+  void StopReadAhead();
+
+  /** Body of the background writer thread: runs a cleaning round every interval until it is stopped. */
+  void BackgroundWriterLoop();
+
+  /**
+   * Writes back dirty unpinned pages of one shard until the clean target is met. The pages of a batch are locked
+   * under the shard latch and written asynchronously and in parallel without it, so foreground threads only wait for
+   * the pages that are being written.
+   * @param shard the shard to clean
+   * @return the number of pages written
+   */
+  size_t CleanShard(BufferPoolShard *shard);
+
+  /** Reads a page from disk and records the latency in the shard's metrics. */
+  void ReadFromDisk(BufferPoolShard *shard, page_id_t page_id, char *page_data);
+
+  /**
+   * Write-ahead logging: waits until the log is persistent up to a page's LSN, before the page is written. Does nothing
+   * if logging is disabled or the log is persistent already.
+   */
+  void ForceLog(lsn_t lsn);
+
+  /** Writes a page to disk, after the log records of the page, and records the latency in the shard's metrics. */
+  void WriteToDisk(BufferPoolShard *shard, page_id_t page_id, const char *page_data);
+
+  /**
+   * Adds a chunk of free frames to a shard. The resize latch must be held.
+   * @return false if the shard reached its maximum size
+   */
+  bool GrowShard(BufferPoolShard *shard);
+
+  /**
+   * Evicts the pages of the last chunk a shard gained and releases its memory. The resize latch must be held.
+   * @return false if the shard has no chunk to release or a page of the last chunk is pinned
+   */
+  bool ShrinkShard(BufferPoolShard *shard);
+
+  /** @return the shard that is responsible for the given page id */
+  inline BufferPoolShard *GetShard(page_id_t page_id) {
+    return &shards_[static_cast<size_t>(page_id) % num_shards_];
+  }
+
+  /**
+   * Finds a frame in the shard that can hold a new page, taking it from the free list first and from the replacer
+   * otherwise. A dirty victim is written back and its page table entry is removed. The frame stays locked (or free)
+   * until the caller publishes the new page with Page::SetPinState. The shard latch must be held.
+   * @param shard the shard to take the frame from
+   * @param[out] frame_id local id of the frame that was found
+   * @param[out] evicted the victim, if it goes to the compressed cache; pass it to CacheEvictedPage after the latch
+   * @return false if every frame of the shard is pinned, true otherwise
+   */
+  bool FindReplacementFrame(BufferPoolShard *shard, frame_id_t *frame_id, EvictedPage *evicted);
+
+  /**
+   * Finds a frame for a page that is loaded through a buffer ring. The ring frame released longest ago is recycled if
+   * it still holds the page the ring put there; otherwise a regular frame is taken and recorded in the ring. A dirty
+   * victim is written back and its page table entry is removed. The frame is handed out like in FindReplacementFrame.
+   * The shard latch must be held.
+   * @param shard the shard to take the frame from
+   * @param strategy the buffer ring of the reader
+   * @param page_id the page that will be loaded into the frame
+   * @param[out] frame_id local id of the frame that was found
+   * @param[out] evicted the victim, if it goes to the compressed cache; pass it to CacheEvictedPage after the latch
+   * @return false if every frame of the shard is pinned, true otherwise
+   */
+  bool FindRingFrame(BufferPoolShard *shard, BufferAccessStrategy *strategy, page_id_t page_id, frame_id_t *frame_id,
+                     EvictedPage *evicted);
+
+  /** Compresses a victim into the compressed cache. Called after the shard latch was released. */
+  void CacheEvictedPage(const EvictedPage &evicted);
+
   /**
    * Grading function. Do not modify!
    * Invokes the callback function if it is not null.
@@ -111,12 +464,42 @@ class BufferPoolManager {
     }
   }
 
+  /**
+   * Looks up a resident page under the shard latch and waits while its frame is locked for I/O.
+   * @param shard the shard of the page
+   * @param guard the held latch of the shard, released while waiting
+   * @param page_id id of the page to look up
+   * @param[out] frame_id the frame of the page
+   * @return false if the page is not resident
+   */
+  bool FindResidentFrame(BufferPoolShard *shard, std::unique_lock<std::mutex> *guard, page_id_t page_id,
+                         frame_id_t *frame_id);
+
+  /**
+   * Pins a resident page without taking the shard latch.
+   * @param shard the shard of the page
+   * @param page_id id of the page to pin
+   * @param[out] page the pinned page
+   * @return false if the page was not found or its frame is locked; exact only under the shard latch
+   */
+  bool TryPinResident(BufferPoolShard *shard, page_id_t page_id, Page **page);
+
+  /**
+   * Unpins a resident page without taking the shard latch.
+   * @param shard the shard of the page
+   * @param page_id id of the page to unpin
+   * @param is_dirty true if the page should be marked as dirty
+   * @return false if the page was not found, is not pinned or its frame is locked; exact only under the shard latch
+   */
+  bool TryUnpinResident(BufferPoolShard *shard, page_id_t page_id, bool is_dirty);
+
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param strategy buffer ring to load the page into on a miss, nullptr to use the regular free list and replacer
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Unpin the target page from the buffer pool.
@@ -136,9 +519,10 @@ class BufferPoolManager {
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param extent extent to take the page from, nullptr to allocate the page on its own
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  Page *NewPageImpl(page_id_t *page_id, PageExtent *extent = nullptr);
 
   /**
    * Deletes a page from the buffer pool.
@@ -148,29 +532,62 @@ class BufferPoolManager {
   bool DeletePageImpl(page_id_t page_id);
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk. The pages are written in page id order, and every run of
+   * consecutive page ids goes to disk in a single vectored write.
    */
   void FlushAllPagesImpl();
 
   /** Number of pages in the buffer pool. */
-  size_t pool_size_;
+  std::atomic<size_t> pool_size_;
+  /** Maximum number of frames in the buffer pool. */
+  size_t max_pool_size_;
+  /** Compressed second tier for evicted pages, nullptr if it is not enabled. */
+  CompressedPageCache *compressed_cache_{nullptr};
+  /** File the warm snapshot is saved to, empty if warm restarts are disabled. */
+  std::string warm_snapshot_file_;
+  /** Serializes calls to Resize. */
+  std::mutex resize_latch_;
+  /** Number of shards the buffer pool is partitioned into. */
+  size_t num_shards_;
+  /** Replacement policy used by every shard. */
+  ReplacerType replacer_type_;
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** Array of shards, each owning a contiguous slice of pages_. */
+  BufferPoolShard *shards_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
-  // /*Mapping offset of array pages with page id */
-  // std::unordered_map<page_id_t,int> offset_map;
-  /** Keeps track of data in page. Used to update dirty bit of page if data changes */
-  // std::unordered_map<page_id_t,std::string> page_data_table;
+  LogManager *log_manager_;
+  /** Number of pages loaded per read-ahead request. */
+  std::atomic<size_t> read_ahead_depth_{READ_AHEAD_DEPTH};
+  /** Background thread serving read-ahead requests, started on the first request. */
+  std::thread *read_ahead_thread_{nullptr};
+  /** Pending read-ahead requests. */
+  std::deque<ReadAheadRequest> read_ahead_queue_;
+  /** True once the read-ahead thread has been asked to exit. */
+  bool read_ahead_stop_{false};
+  /** Protects the read-ahead thread, queue and stop flag. */
+  std::mutex read_ahead_latch_;
+  /** Signalled when a read-ahead request is queued or the thread has to stop. */
+  std::condition_variable read_ahead_cv_;
+  /** Background thread that writes back dirty pages ahead of eviction, nullptr if it is not running. */
+  std::thread *background_writer_thread_{nullptr};
+  /** Fraction of evictable frames the background writer keeps clean. */
+  double clean_target_{0};
+  /** Time between two rounds of the background writer. */
+  std::chrono::milliseconds background_writer_interval_{0};
+  /** True once the background writer has been asked to exit. */
+  bool background_writer_stop_{false};
+  /** Protects the background writer thread, its settings and its stop flag. */
+  std::mutex background_writer_latch_;
+  /** Signalled to start a round early or to stop the background writer. */
+  std::condition_variable background_writer_cv_;
+  /** Total number of pages written by the background writer. */
+  std::atomic<size_t> background_pages_written_{0};
+  /** Pages per second written during the last round. */
+  std::atomic<double> background_write_rate_{0};
+  /** Pages the current round still has to write. */
+  std::atomic<size_t> background_queue_depth_{0};
 };
 }  // namespace bustub
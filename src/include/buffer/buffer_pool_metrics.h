@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_metrics.h
+//
+// Identification: src/include/buffer/buffer_pool_metrics.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "common/util/latency_histogram.h"
+
+namespace bustub {
+
+/**
+ * Counters of a single buffer pool shard. They are only ever incremented, with relaxed atomics and without any latch.
+ */
+struct BufferPoolShardMetrics {
+  /** Fetches of pages that were resident. */
+  std::atomic<uint64_t> fetch_hits_{0};
+  /** Fetches that had to read the page from disk. */
+  std::atomic<uint64_t> fetch_misses_{0};
+  /** Pages created with NewPage. */
+  std::atomic<uint64_t> new_pages_{0};
+  /** Pages evicted to make room for another page. */
+  std::atomic<uint64_t> evictions_{0};
+  /** Evictions that had to write the victim back first. */
+  std::atomic<uint64_t> dirty_writebacks_{0};
+  /** Fetches and new pages that failed because every frame was pinned. */
+  std::atomic<uint64_t> failed_allocations_{0};
+  /** Pages the read-ahead thread loaded; they are not counted as fetches. */
+  std::atomic<uint64_t> read_ahead_pages_{0};
+  /** Latency of the page reads of the shard. */
+  LatencyHistogram read_latency_;
+  /** Latency of the page writes of the shard, including flushes and background writes. */
+  LatencyHistogram write_latency_;
+};
+
+/**
+ * A point-in-time copy of the counters of one shard or, added up, of a whole buffer pool.
+ */
+struct BufferPoolMetrics {
+  uint64_t fetch_hits_{0};
+  uint64_t fetch_misses_{0};
+  uint64_t new_pages_{0};
+  uint64_t evictions_{0};
+  uint64_t dirty_writebacks_{0};
+  uint64_t failed_allocations_{0};
+  uint64_t read_ahead_pages_{0};
+  LatencyHistogramSnapshot read_latency_;
+  LatencyHistogramSnapshot write_latency_;
+
+  /** @return the fraction of fetches that were hits, 0 if there were no fetches */
+  double GetHitRatio() const {
+    uint64_t fetches = fetch_hits_ + fetch_misses_;
+    return fetches == 0 ? 0 : static_cast<double>(fetch_hits_) / fetches;
+  }
+
+  /** Adds the counters of a shard to this snapshot. */
+  void Add(const BufferPoolShardMetrics &shard_metrics);
+
+  /** @return the counters as human readable text, one metric per line */
+  std::string ToString() const;
+};
+
+}  // namespace bustub
@@ -12,12 +12,10 @@
 
 #pragma once
 
-#include <list>
-// #include <mutex>  // NOLINT
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <vector>
-#include <unordered_map>
-#include <iostream>
-#include <algorithm>
+
 #include "buffer/replacer.h"
 #include "common/config.h"
 
@@ -25,6 +23,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The state of every frame lives in dense arrays indexed by frame id, so Pin and Unpin are O(1) and never allocate.
+ * Victim and Unpin serialize on an internal latch to move the clock hand. Pin only flips atomic flags and therefore
+ * never takes the latch.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -45,24 +47,25 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void Release(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
-	/*Vector to store status of frame.
-	(0=false,1=true,-1=irrelevant)
-	[0]->Pin status
-	[1]->reference status
-	[2]->location of frame in replace_list*/
-	std::unordered_map<frame_id_t,std::vector<size_t>> frame_map;
-	/*List of frames considered for replacement
-	-1 indicates empty space in list*/
-	std::vector<frame_id_t> replace_list;
-	//Clock hand for replace_list
-	size_t clock_hand;
-	size_t TOTAL_FRAMES;
-	frame_id_t *blank_id;
-	size_t MAX_FRAMES;
+  /** Number of frames tracked by the replacer. */
+  size_t num_pages_;
+  /** True if the frame is in the replacer, i.e. unpinned and a candidate for eviction. */
+  std::vector<std::atomic<bool>> in_replacer_;
+  /** Reference bit of every frame, set on unpin and cleared when the clock hand passes over the frame. */
+  std::vector<std::atomic<bool>> ref_bits_;
+  /** Number of frames in the replacer. */
+  std::atomic<size_t> size_{0};
+  /** Position of the clock hand. */
+  size_t clock_hand_{0};
+  /** Serializes Victim and Unpin. */
+  std::mutex latch_;
 };
 
-}
+}  // namespace bustub
@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** A point-in-time copy of the counters of a CompressedPageCache. */
+struct CompressedPageCacheStats {
+  /** Lookups that found the page. */
+  uint64_t hits_{0};
+  /** Lookups that did not find the page. */
+  uint64_t misses_{0};
+  /** Pages that were added. */
+  uint64_t insertions_{0};
+  /** Pages that were not added because they did not compress well enough. */
+  uint64_t rejections_{0};
+  /** Pages that were dropped to make room for others. */
+  uint64_t evictions_{0};
+  /** Number of pages in the cache. */
+  size_t num_pages_{0};
+  /** Bytes taken by the compressed pages in the cache. */
+  size_t compressed_bytes_{0};
+
+  /** @return the uncompressed size of the cached pages over their compressed size, 0 if the cache is empty */
+  double GetCompressionRatio() const {
+    return compressed_bytes_ == 0 ? 0 : static_cast<double>(num_pages_ * PAGE_SIZE) / compressed_bytes_;
+  }
+};
+
+/**
+ * CompressedPageCache is a second tier behind the buffer pool. It keeps pages the buffer pool evicted compressed in
+ * memory, so bringing one back costs a decompression instead of a disk read. The cache is exclusive: a page leaves the
+ * cache when it is looked up, and comes back when the buffer pool evicts it again. When full, the least recently added
+ * pages are dropped.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * Creates a new compressed page cache.
+   * @param capacity maximum number of bytes the compressed pages may take
+   */
+  explicit CompressedPageCache(size_t capacity);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  ~CompressedPageCache() = default;
+
+  /**
+   * Adds a page that matches its copy on disk, replacing an older version of it. Pages that shrink by less than a
+   * quarter are not worth the space and are rejected.
+   * @param page_id id of the page
+   * @param page_data the PAGE_SIZE bytes of the page
+   * @return true if the page was added
+   */
+  bool Insert(page_id_t page_id, const char *page_data) { return Insert(page_id, page_data, Reserve(page_id)); }
+
+  /**
+   * Starts adding a page in two steps, so the buffer pool can evict the page under its latch and compress it after.
+   * Drops an older version of the page.
+   * @param page_id id of the page
+   * @return the reservation to pass to Insert
+   */
+  uint64_t Reserve(page_id_t page_id);
+
+  /**
+   * Adds a page reserved with Reserve, unless the page was looked up, erased or reserved again since, in which case
+   * the copy may be outdated.
+   * @param page_id id of the page
+   * @param page_data the PAGE_SIZE bytes of the page at the time of the reservation
+   * @param reservation the result of Reserve
+   * @return true if the page was added
+   */
+  bool Insert(page_id_t page_id, const char *page_data, uint64_t reservation);
+
+  /**
+   * Takes a page out of the cache.
+   * @param page_id id of the page
+   * @param[out] page_data buffer of PAGE_SIZE bytes for the page
+   * @return true if the page was found and decompressed
+   */
+  bool Lookup(page_id_t page_id, char *page_data);
+
+  /**
+   * Drops a page whose copy on disk is going away.
+   * @param page_id id of the page
+   */
+  void Erase(page_id_t page_id);
+
+  /** @return the counters of the cache */
+  CompressedPageCacheStats GetStats();
+
+ private:
+  struct Entry {
+    std::vector<char> data_;
+    std::list<page_id_t>::iterator lru_position_;
+  };
+
+  /** Removes an entry and releases its bytes. The latch must be held. */
+  void RemoveEntry(std::unordered_map<page_id_t, Entry>::iterator entry);
+
+  size_t capacity_;
+  /** Compressed pages by page id. */
+  std::unordered_map<page_id_t, Entry> entries_;
+  /** Page ids from the most to the least recently added. */
+  std::list<page_id_t> lru_list_;
+  /** Open reservations by page id. */
+  std::unordered_map<page_id_t, uint64_t> reservations_;
+  /** The last reservation handed out. */
+  uint64_t last_reservation_{0};
+  /** Counters, compressed_bytes_ and num_pages_ included. */
+  CompressedPageCacheStats stats_;
+  /** Protects all of the above, the cache is shared by every shard of the buffer pool. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of a range of buffer pool frames in one anonymous mapping. Every frame is PAGE_SIZE
+ * aligned, so it can be the target of an O_DIRECT read, and large arenas can be backed by transparent huge pages to
+ * cut down on TLB misses. The address space is reserved up front; memory is only committed when a frame is touched.
+ */
+class FrameArena {
+ public:
+  /** Size of a transparent huge page. */
+  static constexpr size_t HUGE_PAGE_SIZE = static_cast<size_t>(2) << 20;
+
+  /**
+   * Creates a new frame arena. Its frames read as zeroes.
+   * @param num_frames number of frames
+   * @param huge_pages true to ask for transparent huge pages, arenas smaller than a huge page never get them
+   */
+  FrameArena(size_t num_frames, bool huge_pages);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  ~FrameArena();
+
+  /** @return the data of a frame */
+  inline char *GetFrameData(size_t frame) { return data_ + frame * PAGE_SIZE; }
+
+  /**
+   * Returns the memory of a range of frames to the system. The frames stay usable and read as zeroes.
+   * @param first_frame the first frame of the range
+   * @param num_frames number of frames in the range
+   */
+  void Release(size_t first_frame, size_t num_frames);
+
+  /** @return number of frames in the arena */
+  size_t GetNumFrames() const { return num_frames_; }
+
+  /** @return true if the arena is backed by transparent huge pages */
+  bool UsesHugePages() const { return huge_pages_; }
+
+ private:
+  /** Start of the mapping, which is larger than the frames to align them to PAGE_SIZE or a huge page. */
+  char *mapping_;
+  size_t mapping_size_;
+  /** Data of the first frame. */
+  char *data_;
+  size_t num_frames_;
+  bool huge_pages_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose backward k-distance is the largest, where the backward k-distance is the
+ * time between now and the k-th most recent access of the frame. Frames with fewer than k recorded accesses have an
+ * infinite backward k-distance; among those, the least recently used one is evicted first (plain LRU). Pages that
+ * are touched only once, like the pages of a sequential scan, are therefore evicted before pages that are hit again
+ * and again, like hash index block pages.
+ *
+ * An access happens when a frame is unpinned, i.e. once per period in which the frame was in use. Time is logical: the
+ * replacer counts accesses, so the policy does not depend on how fast the machine runs. An access that follows the
+ * previous access of the same frame with fewer than correlated_period accesses of other frames in between continues a
+ * burst of use, such as a scan that pins and unpins its current page once per tuple, and is not recorded as another
+ * access. All operations serialize on an internal latch; the evictable frames are kept ordered, so a victim is found
+ * without looking at every frame.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of most recent accesses that are remembered per frame
+   * @param correlated_period an access of a frame with fewer accesses of other frames since its previous access is
+   * not recorded, 0 records every access
+   */
+  LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period = LRUK_CORRELATED_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Release(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  /** Access history of a single frame. */
+  struct FrameHistory {
+    /** Timestamps of the (at most k) most recent recorded accesses, oldest first. */
+    std::deque<size_t> accesses_;
+    /** Timestamp of the most recent access, recorded or not. */
+    size_t last_access_{0};
+    /** True if the only entry of accesses_ orders a released frame and is not an access. */
+    bool placeholder_{false};
+    /** True if the frame is unpinned and may be victimized. */
+    bool evictable_{false};
+  };
+
+  /** An evictable frame ordered by one of its accesses, the frame to evict first comes first. */
+  using HistoryKey = std::pair<size_t, frame_id_t>;
+
+  /** @return the set an evictable frame is kept in, depending on how many accesses it has */
+  std::set<HistoryKey> *GetEvictableSet(const FrameHistory &frame);
+
+  /** @return the position of an evictable frame in its set: its k-th most recent access, or its last access */
+  HistoryKey GetKey(const FrameHistory &frame, frame_id_t frame_id) const;
+
+  /** Number of accesses remembered per frame. */
+  size_t k_;
+  /** An access with fewer accesses of other frames since the previous access of its frame is not recorded. */
+  size_t correlated_period_;
+  /** Logical clock, advanced on every access. */
+  size_t current_timestamp_{0};
+  /** Per frame history, indexed by frame id. */
+  std::vector<FrameHistory> frames_;
+  /** Evictable frames with fewer than k accesses, by their last access. */
+  std::set<HistoryKey> cold_frames_;
+  /** Evictable frames with k accesses, by their k-th most recent access. */
+  std::set<HistoryKey> hot_frames_;
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
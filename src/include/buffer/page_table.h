@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the resident pages of a buffer pool shard to their frames.
+ *
+ * It is an open-addressing table with linear probing. Every slot packs a page id and a frame id into a single atomic
+ * word, so Find never takes a latch and never sees a torn entry. Insert and Erase must be serialized by the caller
+ * (the shard latch). Erase shifts later entries of the probe sequence back instead of leaving tombstones, which can
+ * make a concurrent Find miss an entry that is being moved. A miss is therefore only a hint, and callers confirm it
+ * under the shard latch.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param num_frames the maximum number of entries the table will be required to store
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * Looks up a page without any latch.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame that holds the page
+   * @return true if the page was found
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Adds a page, or moves it to another frame if it is already in the table.
+   * @param page_id the page to add
+   * @param frame_id the frame that holds the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Removes a page.
+   * @param page_id the page to remove
+   * @return true if the page was in the table
+   */
+  bool Erase(page_id_t page_id);
+
+ private:
+  /** Content of an empty slot. No entry packs to it, because INVALID_PAGE_ID is never stored. */
+  static constexpr uint64_t EMPTY_SLOT = UINT64_MAX;
+
+  static inline uint64_t PackEntry(page_id_t page_id, frame_id_t frame_id) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32 | static_cast<uint32_t>(frame_id);
+  }
+  static inline page_id_t UnpackPageId(uint64_t entry) { return static_cast<page_id_t>(entry >> 32); }
+  static inline frame_id_t UnpackFrameId(uint64_t entry) { return static_cast<frame_id_t>(entry); }
+
+  /** @return the slot at which the probe sequence of the page starts */
+  size_t HomeSlot(page_id_t page_id) const;
+
+  /** Number of slots minus one; the number of slots is a power of two. */
+  size_t mask_;
+  /** log2 of the number of slots. */
+  size_t shift_;
+  /** The slots of the table. */
+  std::vector<std::atomic<uint64_t>> slots_;
+};
+
+}  // namespace bustub
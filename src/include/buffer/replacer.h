@@ -16,6 +16,9 @@
 
 namespace bustub {
 
+/** The replacement policies the buffer pool manager can be configured with. */
+enum class ReplacerType { CLOCK, LRU_K };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +46,20 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Makes an unpinned frame evictable again without counting it as a use, e.g. after the buffer pool manager had it
+   * locked for I/O and a Victim call dropped it in the meantime.
+   * @param frame_id the id of the frame to release
+   */
+  virtual void Release(frame_id_t frame_id) = 0;
+
+  /**
+   * Takes a frame out of the replacer and forgets how it was used, because it is about to hold a different page or
+   * none at all.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
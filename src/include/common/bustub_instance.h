@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
@@ -18,21 +19,38 @@
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/memory_disk_manager.h"
 
 namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * Creates a new instance of the database.
+   * @param db_file_name the file name of the database file
+   * @param in_memory true to keep the pages and the log in memory (see MemoryDiskManager), no files are touched then
+   * @param pool_size initial number of frames of the buffer pool, it can grow to BUFFER_POOL_MAX_SIZE frames or to
+   * pool_size if that is larger
+   */
+  explicit BustubInstance(const std::string &db_file_name, bool in_memory = false,
+                          size_t pool_size = BUFFER_POOL_SIZE) {
     enable_logging = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    if (in_memory) {
+      disk_manager_ = new MemoryDiskManager();
+    } else {
+      disk_manager_ = new DiskManager(db_file_name);
+    }
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManager(pool_size, disk_manager_, log_manager_, 1, ReplacerType::CLOCK,
+                                                 std::max<size_t>(pool_size, BUFFER_POOL_MAX_SIZE));
+    if (!in_memory) {
+      buffer_pool_manager_->EnableWarmRestart(db_file_name + ".warm");
+    }
 
     // txn related
     lock_manager_ = new LockManager(TwoPLMode::STRICT, DeadlockMode::PREVENTION);  // S2PL
@@ -54,6 +72,13 @@ class BustubInstance {
     delete disk_manager_;
   }
 
+  /**
+   * Grows or shrinks the buffer pool while the database is in use, see BufferPoolManager::Resize.
+   * @param pool_size the requested number of frames
+   * @return the number of frames after resizing
+   */
+  size_t ResizeBufferPool(size_t pool_size) { return buffer_pool_manager_->Resize(pool_size); }
+
   DiskManager *disk_manager_;
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
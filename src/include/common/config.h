@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 // #include <shared_mutex>
 namespace bustub {
@@ -27,14 +28,33 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** Size of a data page, set with the BUSTUB_PAGE_SIZE CMake option. */
+#ifndef BUSTUB_PAGE_SIZE
+#define BUSTUB_PAGE_SIZE 4096
+#endif
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
-static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_SIZE = BUSTUB_PAGE_SIZE;                            // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;  // number of accesses the LRU-K replacer remembers per frame
+static constexpr size_t LRUK_CORRELATED_PERIOD = 16;  // accesses of other frames within which a reuse counts as one
+static constexpr int BUFFER_RING_SIZE = 16;  // number of frames a sequential scan recycles
+static constexpr int READ_AHEAD_DEPTH = 4;   // number of pages prefetched ahead of a sequential scan
+static constexpr int BUFFER_POOL_MAX_SIZE = 1024;  // size the buffer pool of a BustubInstance can grow to
+static constexpr int BUFFER_POOL_CHUNK_SIZE = 16;  // number of frames a shard gains or loses per resize step
+static constexpr int WARM_RESTART_THREADS = 4;     // number of threads that read a warm snapshot back at startup
+static constexpr bool BUFFER_POOL_HUGE_PAGES = true;  // back large buffer pools with transparent huge pages
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;        // maximum number of asynchronous disk requests in flight
+static constexpr int ASYNC_IO_THREADS = 8;  // number of threads serving asynchronous requests without io_uring
+static constexpr int EXTENT_SIZE = 64;      // number of consecutive pages a table reserves at a time
+
+static_assert(PAGE_SIZE >= 4096 && PAGE_SIZE <= 32768 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+              "PAGE_SIZE must be 4, 8, 16 or 32 KB");
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
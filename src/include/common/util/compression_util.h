@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util.h
+//
+// Identification: src/include/common/util/compression_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * CompressionUtil is a small LZ77 codec in the style of LZ4: a single greedy pass with a hash table of recent 4 byte
+ * sequences, and a byte aligned format that decodes with plain copies. It trades ratio for speed, which is what page
+ * sized blocks that are compressed and decompressed on the hot path need.
+ *
+ * The compressed data is a list of sequences. Every sequence starts with a token whose upper four bits are the number
+ * of literals and whose lower four bits are the match length minus MIN_MATCH; a nibble of 15 is followed by more
+ * length bytes, each adding up to 255. Then come the literals, a two byte little endian offset and the match is copied
+ * from that far back. The last sequence only has literals.
+ */
+class CompressionUtil {
+ public:
+  /** Shortest match the codec encodes. */
+  static constexpr size_t MIN_MATCH = 4;
+  /** Farthest back a match can start. */
+  static constexpr size_t MAX_OFFSET = 65535;
+
+  /**
+   * @param size number of bytes to compress
+   * @return the largest size Compress can produce, for data that does not compress at all
+   */
+  static constexpr size_t MaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+  /**
+   * Compresses a block of data.
+   * @param src the data to compress
+   * @param size number of bytes to compress
+   * @param[out] dst buffer for the compressed data
+   * @param capacity size of dst
+   * @return the compressed size, 0 if it would exceed capacity
+   */
+  static size_t Compress(const char *src, size_t size, char *dst, size_t capacity);
+
+  /**
+   * Decompresses a block of data produced by Compress. Malformed input is detected and never read or written out of
+   * bounds.
+   * @param src the compressed data
+   * @param size number of compressed bytes
+   * @param[out] dst buffer for the decompressed data
+   * @param capacity size of dst
+   * @return the decompressed size, 0 if the input is malformed or does not fit into capacity
+   */
+  static size_t Decompress(const char *src, size_t size, char *dst, size_t capacity);
+};
+
+}  // namespace bustub
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.h
+//
+// Identification: src/include/common/util/latency_histogram.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/** Each power of two of a latency histogram is split into 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS linear sub-buckets. */
+static constexpr size_t LATENCY_HISTOGRAM_SUB_BUCKET_BITS = 4;
+static constexpr size_t LATENCY_HISTOGRAM_SUB_BUCKETS = static_cast<size_t>(1) << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+/** Latencies of 2^LATENCY_HISTOGRAM_MAX_BITS nanoseconds (about 18 minutes) and more land in the last bucket. */
+static constexpr size_t LATENCY_HISTOGRAM_MAX_BITS = 40;
+/**
+ * Number of buckets of a latency histogram. Latencies below LATENCY_HISTOGRAM_SUB_BUCKETS nanoseconds have a bucket
+ * each, larger ones share a bucket with the latencies that agree in the highest LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1
+ * bits, so a bucket is at most 1/16 of its latencies wide.
+ */
+static constexpr size_t LATENCY_HISTOGRAM_BUCKETS =
+    (LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * LATENCY_HISTOGRAM_SUB_BUCKETS;
+
+/**
+ * A point-in-time copy of a LatencyHistogram. Snapshots of several histograms can be added up.
+ */
+struct LatencyHistogramSnapshot {
+  /** Number of recorded latencies per bucket. */
+  std::array<uint64_t, LATENCY_HISTOGRAM_BUCKETS> buckets_{};
+  /** Number of recorded latencies. */
+  uint64_t count_{0};
+  /** Sum of the recorded latencies in nanoseconds. */
+  uint64_t total_nanos_{0};
+
+  /** @return the mean latency in nanoseconds, 0 if nothing was recorded */
+  double GetMean() const { return count_ == 0 ? 0 : static_cast<double>(total_nanos_) / count_; }
+
+  /**
+   * @param percentile the percentile to compute, between 0 and 100
+   * @return an upper bound of the percentile in nanoseconds (the end of its bucket, at most 1/16 above it), 0 if
+   * nothing was recorded
+   */
+  uint64_t GetPercentile(double percentile) const;
+
+  /** Adds the counts of another snapshot to this one. */
+  void Merge(const LatencyHistogramSnapshot &other);
+};
+
+/**
+ * LatencyHistogram counts latencies in log-linear buckets, like an HDR histogram: every power of two is split into
+ * LATENCY_HISTOGRAM_SUB_BUCKETS equal sub-buckets, so percentiles keep a relative error of at most 1/16 from
+ * nanoseconds to minutes. Recording is a few relaxed atomic increments, so it is cheap enough to sit on every disk
+ * access.
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram() = default;
+
+  DISALLOW_COPY_AND_MOVE(LatencyHistogram);
+
+  /** Records a single latency. */
+  void Record(std::chrono::nanoseconds latency);
+
+  /** @return a copy of the current counts */
+  LatencyHistogramSnapshot GetSnapshot() const;
+
+ private:
+  std::array<std::atomic<uint64_t>, LATENCY_HISTOGRAM_BUCKETS> buckets_{};
+  std::atomic<uint64_t> total_nanos_{0};
+};
+
+}  // namespace bustub
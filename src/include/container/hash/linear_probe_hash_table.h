@@ -104,6 +104,18 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
 
 	HashTableHeaderPage *header_page_;
 
+	/**
+	 * Collects the values of all readable slots of a block page that match the key, probing from the given slot.
+	 * Only reads the block page, so it can run without the page latch and be validated afterwards.
+	 * @param block_page the block page to scan
+	 * @param page_slot_index the slot the probe starts at
+	 * @param key the key to look up
+	 * @param[out] result the matching values
+	 * @return true if the probe reached a never occupied slot, i.e. the following block pages need not be scanned
+	 */
+	bool ScanBlock(HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t page_slot_index, const KeyType &key,
+	               std::vector<ValueType> *result);
+
 
 };
 
@@ -37,7 +37,7 @@ class CheckpointManager {
  private:
   TransactionManager *transaction_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  BufferPoolManager *buffer_pool_manager_;
 };
 
 }  // namespace bustub
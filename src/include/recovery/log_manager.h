@@ -16,6 +16,7 @@
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,6 +26,11 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * The log is double buffered: the flush thread swaps the log buffer with the flush buffer and writes the flush buffer
+ * out while appenders go on filling the log buffer. A committing transaction waits until its commit record is
+ * persistent, and the commits that arrive while one write is in flight all go out with the next write (group commit),
+ * so commit throughput grows with the number of committers instead of being bound by the rate of log syncs.
  */
 class LogManager {
  public:
@@ -35,6 +41,7 @@ class LogManager {
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -46,13 +53,23 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
+  /**
+   * Blocks until the log is persistent up to and including a log sequence number, and asks the flush thread to flush
+   * right away rather than at its next timeout. Returns immediately if the flush thread is not running.
+   * @param lsn the log sequence number that must be persistent, e.g. of a commit record or of a page to be written
+   */
+  void Flush(lsn_t lsn);
+
   inline lsn_t GetNextLSN() { return next_lsn_; }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** Writes a log record into the log buffer at log_buffer_offset_, latch_ must be held. */
+  void SerializeLogRecord(LogRecord *log_record);
+  /** The body of the flush thread. */
+  void FlushLoop();
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
@@ -61,14 +78,25 @@ class LogManager {
 
   char *log_buffer_;
   char *flush_buffer_;
-
+  /** The number of bytes of the log buffer in use. */
+  size_t log_buffer_offset_{0};
+  /** Set when the log buffer is full or a transaction waits for the log, until the flush thread swaps the buffers. */
+  bool flush_requested_{false};
+  /** Cleared to make the flush thread flush what is left and exit. */
+  bool running_{false};
+
+  /** Protects the log buffer and the flags, the flush buffer belongs to the flush thread. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  /** The flush thread, nullptr once it was stopped and joined. Read and written under latch_. */
+  std::thread *flush_thread_{nullptr};
 
+  /** Wakes up the flush thread. */
   std::condition_variable cv_;
+  /** Wakes up appenders waiting for room and transactions waiting for the log, whenever the flush thread progresses. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_engine.h
+//
+// Identification: src/include/storage/disk/async_io_engine.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <functional>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+/**
+ * Called once an asynchronous request completed, with false if it failed. It runs on a thread of the engine, so it
+ * must be short and must not submit requests itself.
+ */
+using io_callback_fn = std::function<void(bool)>;
+
+/** An asynchronous read or write of a range of a file. */
+struct AsyncIORequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** Buffer to read into or to write from, it must stay valid until the callback ran. */
+  char *data_;
+  /** Number of bytes to transfer. */
+  size_t size_;
+  /** Offset of the range in the file. */
+  off_t offset_;
+  /** Completion callback. */
+  io_callback_fn callback_;
+};
+
+/**
+ * AsyncIOEngine keeps many reads and writes of a file in flight at once. Requests are submitted without waiting for
+ * them, and a callback reports their completion. Reads that reach the end of the file fill the rest of the buffer with
+ * zeroes. An engine either drives io_uring, or has a pool of threads issue pread and pwrite where io_uring is not
+ * available.
+ */
+class AsyncIOEngine {
+ public:
+  virtual ~AsyncIOEngine() = default;
+
+  /**
+   * Submits a request. Blocks while the engine already has its queue depth of requests in flight.
+   * @param request the request to submit
+   */
+  virtual void Submit(AsyncIORequest request) = 0;
+
+  /** @return the name of the backend */
+  virtual const char *GetName() const = 0;
+
+  /** Waits until every submitted request completed and its callback ran. */
+  void Wait();
+
+  /**
+   * Creates an engine on io_uring if the kernel supports it, otherwise on a thread pool.
+   * @param fd the file to read and write, it must stay open as long as the engine exists
+   * @param queue_depth maximum number of requests in flight
+   * @param num_threads number of threads of the thread pool, if it comes to that
+   * @return the new engine, owned by the caller
+   */
+  static AsyncIOEngine *Create(int fd, size_t queue_depth, size_t num_threads);
+
+  /** @return a new engine on io_uring, nullptr if the kernel does not support it */
+  static AsyncIOEngine *CreateIoUring(int fd, size_t queue_depth);
+
+  /** @return a new engine on a pool of num_threads threads */
+  static AsyncIOEngine *CreateThreadPool(int fd, size_t queue_depth, size_t num_threads);
+
+ protected:
+  explicit AsyncIOEngine(size_t queue_depth) : queue_depth_(queue_depth) {}
+
+  /** Reserves room for a request, waiting while queue_depth requests are in flight. */
+  void BeginRequest();
+
+  /** Runs the callback of a completed request and frees its room. */
+  void EndRequest(const io_callback_fn &callback, bool success);
+
+ private:
+  size_t queue_depth_;
+  size_t in_flight_{0};
+  std::mutex in_flight_latch_;
+  std::condition_variable in_flight_cv_;
+};
+
+}  // namespace bustub
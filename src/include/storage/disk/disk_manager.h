@@ -13,53 +13,136 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/async_io_engine.h"
+#include "storage/disk/disk_manager_metrics.h"
+#include "storage/disk/page_allocator.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ * Pages are read and written with positional I/O, so any number of threads can do so at the same time. A written page
+ * reaches the operating system right away, but is only durable after the next call to Sync. Pages can also be read
+ * and written asynchronously, which keeps many requests in flight on io_uring where the kernel supports it.
+ *
+ * With direct I/O the database file is opened with O_DIRECT, so pages bypass the kernel page cache and are only held
+ * once, in the buffer pool. Direct I/O transfers into PAGE_SIZE aligned buffers, like the buffer pool frames; pages in
+ * unaligned buffers are staged through an aligned copy.
+ *
+ * The file starts with a header page, which records the PAGE_SIZE the file was created with, and a bitmap of the
+ * allocated pages is kept in the file as well (see PageAllocator), so deallocated pages are reused, also after the
+ * database was reopened.
+ *
+ * With page compression every page is compressed when it is written. The compressed image takes the place of the page
+ * in the file, and the rest of the page's slot is punched out as a hole. Holes only free whole file system blocks, so
+ * a page is only stored compressed if that frees at least one block, and compression is refused on file systems whose
+ * blocks are larger than half a page, where it could never save space. A compressed image starts with a magic number,
+ * its size and a checksum, so it is recognized by its content. Each group of the file keeps a stored size map next to
+ * its bitmap page (see PageAllocator), with one entry per page that flags the pages stored compressed and the size of
+ * their images, so reads only transfer the stored image. The map pages are written back with the bitmap pages when
+ * the file is synced; the map is only a hint, a page whose entry was lost in a crash is read in full and recognized
+ * by its image. A file has to be opened with the compression setting it was written with.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the page cache, the file is opened normally if its file system cannot do that
+   * @param compress_pages true to compress pages on disk
+   * @param block_size the block size compressed pages are laid out for, a multiple of 512; 0 to use the block size of
+   * the file system, a smaller one still works but saves less space
+   * @throws Exception if the database file is not empty and no database file, if it was created with a different
+   * PAGE_SIZE, or if pages are to be compressed in blocks larger than half a page
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false, bool compress_pages = false,
+                       size_t block_size = 0);
 
-  ~DiskManager() = default;
+  /**
+   * Destroys the disk manager, shutting it down first if that was not done.
+   */
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. The page is not synced to disk, see Sync.
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  virtual void WritePage(page_id_t page_id, const char *page_data);
+
+  /**
+   * Write a run of pages with consecutive ids to the database file using a single vectored write.
+   * @param first_page_id id of the first page in the run
+   * @param pages_data raw page data of the pages first_page_id, first_page_id + 1, ...
+   * @param num_pages number of pages in the run
+   */
+  virtual void WritePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages);
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  virtual void ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Read a run of pages with consecutive ids from the database file using a single vectored read. Pages past the end
+   * of the file are zeroed.
+   * @param first_page_id id of the first page in the run
+   * @param[out] pages_data output buffers of the pages first_page_id, first_page_id + 1, ...
+   * @param num_pages number of pages in the run
+   */
+  virtual void ReadPages(page_id_t first_page_id, char *const *pages_data, size_t num_pages);
+
+  /**
+   * Start writing a page to the database file without waiting for it. The page is not synced to disk, see Sync.
+   * @param page_id id of the page
+   * @param page_data raw page data, it must stay unchanged until the callback ran
+   * @param callback called once the page is written, see io_callback_fn
+   */
+  virtual void WritePageAsync(page_id_t page_id, const char *page_data, io_callback_fn callback);
+
+  /**
+   * Start reading a page from the database file without waiting for it. A page past the end of the file reads as
+   * zeroes.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, it is filled once the callback runs
+   * @param callback called once the page is read, see io_callback_fn
+   */
+  virtual void ReadPageAsync(page_id_t page_id, char *page_data, io_callback_fn callback);
+
+  /** Waits until every asynchronous read and write completed. */
+  virtual void WaitForAsyncIO();
+
+  /** @return the name of the backend of asynchronous reads and writes */
+  virtual const char *GetAsyncIOBackend();
+
+  /**
+   * Make every page written so far durable. This is the expensive part of a write, so callers batch it: the buffer pool
+   * syncs once per FlushAllPages instead of once per page.
+   */
+  virtual void Sync();
 
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -68,19 +151,38 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  virtual bool ReadLog(char *log_data, int size, int offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk. Deallocated pages are reused, the lowest page id first. Like the pages written, the
+   * allocation is durable after the next call to Sync, as made by FlushAllPages of the buffer pool or by shutting
+   * down or destroying the disk manager.
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  virtual page_id_t AllocatePage();
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so it can be allocated again. The deallocation is durable after the next call to Sync.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(page_id_t page_id);
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Reserve a run of consecutive pages on disk, to be allocated one by one with AllocateReservedPage. Pages of the run
+   * that were never allocated are free again once the database is reopened.
+   * @param num_pages number of pages in the run
+   * @return the id of the first page of the run
+   */
+  virtual page_id_t ReserveExtent(size_t num_pages);
+
+  /**
+   * Allocate a page that was reserved with ReserveExtent.
+   * @param page_id id of the page
+   */
+  virtual void AllocateReservedPage(page_id_t page_id);
+
+  /** @return true if the page is allocated */
+  virtual bool IsPageAllocated(page_id_t page_id);
 
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
@@ -88,9 +190,30 @@ class DiskManager {
   /** @return true iff the in-memory content has not been flushed yet */
   bool GetFlushState() const;
 
-  /** @return the number of disk writes */
+  /** @return the number of disk writes, a vectored write of several pages counts once */
   int GetNumWrites() const;
 
+  /** @return the number of disk reads, a vectored read of several pages counts once */
+  int GetNumReads() const;
+
+  /** @return the number of syncs of the database file */
+  int GetNumSyncs() const;
+
+  /** @return the I/O counters of the database file and the log file; GetMetrics().ToString() dumps them as text */
+  DiskManagerMetrics GetMetrics() const;
+
+  /** @return true if the database file bypasses the page cache */
+  bool UsesDirectIO() const { return direct_io_; }
+
+  /** @return true if pages are compressed on disk */
+  bool UsesPageCompression() const { return compress_pages_; }
+
+  /**
+   * @param page_id id of the page
+   * @return the number of bytes the page takes in the database file, PAGE_SIZE for pages stored as they are
+   */
+  size_t GetStoredPageSize(page_id_t page_id);
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -100,19 +223,69 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
+ protected:
+  /** Creates a disk manager without a database file or log file, for subclasses that keep pages elsewhere. */
+  DiskManager() = default;
+
+  PageAllocator allocator_;
+  // I/O on the database file and on the log file
+  FileIOCounters data_file_io_;
+  FileIOCounters log_file_io_;
+  std::atomic<bool> flush_log_{false};
+  std::future<void> *flush_log_f_{nullptr};
+
  private:
   int GetFileSize(const std::string &file_name);
+  /** Sets up the file header of a new db file, or loads the bitmap and stored size map pages of an existing one. */
+  void LoadAllocator();
+  /** Writes a page image at an offset of the db file. */
+  void WriteAt(off_t offset, const char *page_data, size_t size = PAGE_SIZE);
+  /** Reads a page image at an offset of the db file, the part past the end of the file as zeroes. */
+  void ReadAt(off_t offset, char *page_data, size_t size = PAGE_SIZE);
+  /** Compresses a page and writes its image. */
+  void WriteCompressedPage(page_id_t page_id, const char *page_data);
+  /** Reads the image of a page and decompresses it. */
+  void ReadCompressedPage(page_id_t page_id, char *page_data);
+  /** Turns the bytes read from the slot of a page into the page, reads the whole slot if they are no complete image. */
+  void DecodeStoredPage(page_id_t page_id, char *image, size_t image_size, char *page_data);
+  /** Records the size of the image of a page in the stored size map, PAGE_SIZE for a page stored as it is. */
+  void SetStoredPageSize(page_id_t page_id, size_t stored_size);
+  /** @return the stored size map entry of a page, 0 for a page stored as it is */
+  uint8_t GetStoredSizeEntry(page_id_t page_id);
+  /** Frees the file system blocks that lie entirely within a range of the db file. */
+  void PunchHole(off_t offset, size_t size);
+  /** Writes a run of pages that are consecutive in the db file. */
+  void WriteRun(page_id_t first_page_id, const char *const *pages_data, size_t num_pages);
+  /** Reads a run of pages that are consecutive in the db file. */
+  void ReadRun(page_id_t first_page_id, char *const *pages_data, size_t num_pages);
+  /** @return true if a buffer has to be staged through an aligned copy to be read or written */
+  bool NeedsStaging(const char *buffer) const;
+  /** @return the asynchronous I/O engine, which is started on first use */
+  AsyncIOEngine *GetAsyncIOEngine();
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the log file, only used to sync the log
+  int log_fd_{-1};
+  // file descriptor of the db file, only used with positional reads and writes
+  int db_fd_{-1};
+  // true if db_fd_ was opened with O_DIRECT
+  bool direct_io_{false};
+  // true if pages are stored compressed
+  bool compress_pages_{false};
+  // block size of the file system of the db file or the one asked for, holes are punched in whole blocks
+  size_t fs_block_size_{PAGE_SIZE};
+  // stored size map entry of each page, in whole groups, see STORED_PAGE_COMPRESSED
+  std::vector<uint8_t> stored_sizes_;
+  // true for each stored size map page that changed since it was last written back
+  std::vector<bool> stored_sizes_dirty_;
+  std::mutex stored_sizes_latch_;
+  // asynchronous I/O engine on db_fd_, nullptr until the first asynchronous request
+  AsyncIOEngine *async_io_{nullptr};
+  std::mutex async_io_latch_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
-  std::future<void> *flush_log_f_;
+  // serializes writing back the bitmap pages
+  std::mutex sync_latch_;
 };
 
 }  // namespace bustub
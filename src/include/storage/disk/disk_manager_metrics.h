@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_metrics.h
+//
+// Identification: src/include/storage/disk/disk_manager_metrics.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+
+#include "common/util/latency_histogram.h"
+
+namespace bustub {
+
+/**
+ * Counters of the I/O on one file of a disk manager. They are only ever incremented, with relaxed atomics and without
+ * any latch, so any number of threads can record at once. Only pages and log records are counted, not the bookkeeping
+ * of the file such as its allocation bitmap.
+ */
+struct FileIOCounters {
+  /** Read requests, a vectored read of several pages counts once. */
+  std::atomic<uint64_t> reads_{0};
+  /** Write requests, a vectored write of several pages counts once. */
+  std::atomic<uint64_t> writes_{0};
+  std::atomic<uint64_t> bytes_read_{0};
+  std::atomic<uint64_t> bytes_written_{0};
+  /** Calls to fsync or fdatasync. */
+  std::atomic<uint64_t> syncs_{0};
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+  LatencyHistogram sync_latency_;
+
+  /** Records a read request. */
+  void RecordRead(size_t num_bytes, std::chrono::nanoseconds latency) {
+    reads_.fetch_add(1, std::memory_order_relaxed);
+    bytes_read_.fetch_add(num_bytes, std::memory_order_relaxed);
+    read_latency_.Record(latency);
+  }
+
+  /** Records a write request. */
+  void RecordWrite(size_t num_bytes, std::chrono::nanoseconds latency) {
+    writes_.fetch_add(1, std::memory_order_relaxed);
+    bytes_written_.fetch_add(num_bytes, std::memory_order_relaxed);
+    write_latency_.Record(latency);
+  }
+
+  /** Records a sync. */
+  void RecordSync(std::chrono::nanoseconds latency) {
+    syncs_.fetch_add(1, std::memory_order_relaxed);
+    sync_latency_.Record(latency);
+  }
+};
+
+/**
+ * A point-in-time copy of the counters of one file.
+ */
+struct FileIOMetrics {
+  uint64_t reads_{0};
+  uint64_t writes_{0};
+  uint64_t bytes_read_{0};
+  uint64_t bytes_written_{0};
+  uint64_t syncs_{0};
+  LatencyHistogramSnapshot read_latency_;
+  LatencyHistogramSnapshot write_latency_;
+  LatencyHistogramSnapshot sync_latency_;
+
+  /** Adds the counters of a file to this snapshot. */
+  void Add(const FileIOCounters &counters);
+};
+
+/**
+ * A point-in-time copy of the I/O counters of a disk manager, for its database file and its log file.
+ */
+struct DiskManagerMetrics {
+  FileIOMetrics data_;
+  FileIOMetrics log_;
+
+  /** @return the counters as human readable text, one metric per line */
+  std::string ToString() const;
+};
+
+}  // namespace bustub
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_disk_manager.h
+//
+// Identification: src/include/storage/disk/memory_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/rwlatch.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * MemoryDiskManager is a DiskManager that keeps the pages and the log in memory instead of in files. Nothing survives
+ * the disk manager, which suits temporary databases and benchmarks that should measure the CPU side of the buffer pool,
+ * the indexes and the executors without file system noise.
+ *
+ * Pages are held in a page store that grows with the highest page id written, and allocation works like on disk (see
+ * PageAllocator). Asynchronous requests complete before they return, Sync does nothing but count. Any number of threads
+ * can read and overwrite pages at the same time: the bytes of each page are guarded by one of a fixed set of page
+ * latches, picked by page id, and only writes that add a page to the page store latch the whole store.
+ */
+class MemoryDiskManager : public DiskManager {
+ public:
+  MemoryDiskManager() = default;
+
+  ~MemoryDiskManager() override;
+
+  DISALLOW_COPY_AND_MOVE(MemoryDiskManager);
+
+  /** Keeps the pages, they are freed with the disk manager. */
+  void ShutDown() override {}
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void WritePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) override;
+
+  /** A page that was never written reads as zeroes. */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void ReadPages(page_id_t first_page_id, char *const *pages_data, size_t num_pages) override;
+
+  /** Writes the page right away, the callback runs before this returns. */
+  void WritePageAsync(page_id_t page_id, const char *page_data, io_callback_fn callback) override;
+
+  /** Reads the page right away, the callback runs before this returns. */
+  void ReadPageAsync(page_id_t page_id, char *page_data, io_callback_fn callback) override;
+
+  void WaitForAsyncIO() override {}
+
+  const char *GetAsyncIOBackend() override { return "memory"; }
+
+  void Sync() override;
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int offset) override;
+
+  /** @return the number of pages the page store holds */
+  size_t GetNumStoredPages();
+
+ private:
+  /** Number of latches that guard the bytes of the pages, a page uses the one at its id modulo this. */
+  static constexpr size_t NUM_PAGE_LATCHES = 64;
+
+  /** Copies a run of pages into the page store, taking pages_latch_ in write mode only to add pages. */
+  void StorePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages);
+  /** Copies a page into the page store, pages_latch_ must be held in write mode. */
+  void StorePage(page_id_t page_id, const char *page_data);
+  /** Copies a page out of the page store under its page latch, pages_latch_ must be held. */
+  void LoadPage(page_id_t page_id, char *page_data);
+  /** @return the latch that guards the bytes of a page */
+  ReaderWriterLatch *GetPageLatch(page_id_t page_id) {
+    return &page_latches_[static_cast<size_t>(page_id) % NUM_PAGE_LATCHES];
+  }
+
+  // data of each page by id, nullptr for pages that were never written
+  std::vector<char *> pages_;
+  // guards the page table pages_, in write mode also the bytes of all pages
+  ReaderWriterLatch pages_latch_;
+  // guard the bytes of the pages while pages_latch_ is held in read mode
+  std::array<ReaderWriterLatch, NUM_PAGE_LATCHES> page_latches_;
+  // the log, as it would be in the log file
+  std::vector<char> log_;
+  std::mutex log_latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_allocator.h
+//
+// Identification: src/include/storage/disk/page_allocator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageAllocator keeps track of the pages of a database file that are in use, so that deallocated pages are handed out
+ * again instead of growing the file.
+ *
+ * Pages are tracked by a bitmap with one bit per page. The file is laid out in groups: a group starts with a bitmap
+ * page covering the PAGES_PER_GROUP data pages of the group, followed by the SIZE_MAP_PAGES_PER_GROUP pages of the
+ * stored size map, which the disk manager keeps for compressed pages, and then the data pages. The first page of the
+ * file is the file header, so the data page with id p lives at physical page GetPhysicalPage(p). The bitmap pages are
+ * kept in memory and written back by the disk manager when the file is synced.
+ *
+ * Runs of consecutive pages can be reserved as extents for a single table or index. A reserved page is skipped by
+ * other allocations, but only marked in the bitmap once it is allocated, so reservations that were never used are gone
+ * after a restart instead of leaking pages.
+ */
+class PageAllocator;
+
+/**
+ * PageExtent is a run of consecutive pages reserved for one table or index. BufferPoolManager::NewPageInExtent hands
+ * its pages out in order and reserves the next extent once it is used up, so the pages of the object sit next to each
+ * other in the file and scans of it become sequential I/O. NewPageInExtent must not run concurrently on one extent.
+ */
+struct PageExtent {
+  /** @param size number of pages reserved at a time */
+  explicit PageExtent(size_t size = EXTENT_SIZE);
+
+  /** Number of pages reserved at a time. */
+  size_t size_;
+  /** Next page to hand out. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** End of the extent, the extent is used up once next_page_id_ reaches it. */
+  page_id_t end_page_id_{INVALID_PAGE_ID};
+};
+
+class PageAllocator {
+ public:
+  /** Number of data pages one bitmap page keeps track of. */
+  static constexpr page_id_t PAGES_PER_GROUP = PAGE_SIZE * 8;
+
+  /** Number of stored size map pages of a group, they hold one byte per data page. */
+  static constexpr size_t SIZE_MAP_PAGES_PER_GROUP = PAGES_PER_GROUP / PAGE_SIZE;
+
+  /** @return the position of a data page in the file, in pages */
+  static size_t GetPhysicalPage(page_id_t page_id) {
+    return GetSizeMapPhysicalPage(page_id / PAGES_PER_GROUP) + SIZE_MAP_PAGES_PER_GROUP + page_id % PAGES_PER_GROUP;
+  }
+
+  /** @return the position of the bitmap page of a group in the file, in pages */
+  static size_t GetBitmapPhysicalPage(size_t group) {
+    return 1 + group * (1 + SIZE_MAP_PAGES_PER_GROUP + PAGES_PER_GROUP);
+  }
+
+  /** @return the position of the first stored size map page of a group in the file, in pages */
+  static size_t GetSizeMapPhysicalPage(size_t group) { return GetBitmapPhysicalPage(group) + 1; }
+
+  /**
+   * Restores the bitmap page of the next group, read from the file.
+   * @param bitmap_data the bitmap page, zeroes if it was never written
+   */
+  void LoadGroup(const char *bitmap_data);
+
+  /** @return the id of a page that was free, now marked as in use */
+  page_id_t Allocate();
+
+  /**
+   * Reserves a run of consecutive free pages, all in the same group.
+   * @param num_pages number of pages in the run, at most PAGES_PER_GROUP
+   * @return the id of the first page of the run
+   */
+  page_id_t Reserve(size_t num_pages);
+
+  /**
+   * Marks a reserved page as in use.
+   * @param page_id id of a page returned by Reserve
+   */
+  void AllocateReserved(page_id_t page_id);
+
+  /**
+   * Marks a page as free. Deallocating a free page does nothing.
+   * @param page_id id of the page
+   */
+  void Deallocate(page_id_t page_id);
+
+  /** @return true if the page is in use */
+  bool IsAllocated(page_id_t page_id);
+
+  /** @return the number of pages in use */
+  size_t GetNumAllocated();
+
+  /**
+   * Takes the bitmap pages that changed since the last call, they count as written back from then on.
+   * @return pairs of group and a copy of its bitmap page
+   */
+  std::vector<std::pair<size_t, std::vector<char>>> TakeDirtyGroups();
+
+ private:
+  /** @return true if the page is in use or reserved */
+  bool IsTaken(page_id_t page_id) const;
+
+  /** Adds an empty group at the end of the file. */
+  void AddGroup();
+
+  /** Bitmap page of each group. */
+  std::vector<std::vector<char>> groups_;
+  /** Bits of the pages of each group that are reserved but not allocated yet, only kept in memory. */
+  std::vector<std::vector<char>> reserved_;
+  /** True for each group whose bitmap page changed since it was last written back. */
+  std::vector<bool> dirty_;
+  /** No page with a smaller id is free, that is neither in use nor reserved. */
+  page_id_t first_free_hint_{0};
+  size_t num_allocated_{0};
+  std::mutex latch_;
+};
+
+inline PageExtent::PageExtent(size_t size)
+    : size_(std::min(std::max<size_t>(size, 1), static_cast<size_t>(PageAllocator::PAGES_PER_GROUP))) {}
+
+}  // namespace bustub
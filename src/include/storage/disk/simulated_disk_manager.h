@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simulated_disk_manager.h
+//
+// Identification: src/include/storage/disk/simulated_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>  // NOLINT
+#include <random>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * Distribution of the latency of one kind of disk operation. Latencies are log-normal around the median, which gives
+ * the long tail of real devices.
+ */
+struct DiskLatency {
+  /** Median latency, 0 for no latency at all. */
+  std::chrono::microseconds median_{0};
+  /** Standard deviation of the logarithm of the latency, 0 for a constant latency. Larger values mean a longer tail. */
+  double sigma_{0};
+};
+
+/**
+ * The behavior of a simulated storage device.
+ */
+struct SimulatedDiskProfile {
+  /** Latency of reading pages and the log. */
+  DiskLatency read_;
+  /** Latency of writing pages. */
+  DiskLatency write_;
+  /** Latency of writing the log, which also makes it durable. */
+  DiskLatency log_write_;
+  /** Latency of syncing the database file. */
+  DiskLatency sync_;
+  /** Bandwidth all transfers share, in bytes per second; 0 for unlimited. */
+  uint64_t bandwidth_{0};
+  /** Probability that an operation stalls on top of its latency, as on a device that is garbage collecting. */
+  double stall_probability_{0};
+  /** Duration of a stall. */
+  std::chrono::microseconds stall_{0};
+
+  /** @return a profile of a local NVMe SSD */
+  static SimulatedDiskProfile Ssd();
+
+  /** @return a profile of a spinning disk, dominated by seeks */
+  static SimulatedDiskProfile Hdd();
+
+  /** @return a profile of network attached block storage, with a long tail and occasional stalls */
+  static SimulatedDiskProfile NetworkStorage();
+};
+
+/**
+ * SimulatedDiskManager wraps another disk manager and makes it behave like a slower device, to see how the engine
+ * degrades on slow or jittery storage. Each operation is forwarded to the wrapped disk manager, but only completes once
+ * the latency sampled from the profile has passed since it started; the real I/O overlaps that latency. Transfers also
+ * queue up behind each other on the bandwidth of the profile, and occasionally stall.
+ *
+ * Asynchronous requests complete on a timer thread of the simulated disk: once the wrapped disk manager finished a
+ * request, its callback is queued until the latency has passed. The threads of the I/O engine are never held up, so any
+ * number of requests can wait out their latency at once. Wrapping a MemoryDiskManager makes the profile the only source
+ * of I/O latency.
+ */
+class SimulatedDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new simulated disk.
+   * @param disk_manager the disk manager to forward to, it is not owned
+   * @param profile the behavior of the simulated device
+   * @param seed seed of the random latencies, the same seed gives the same latencies for the same operations
+   */
+  SimulatedDiskManager(DiskManager *disk_manager, const SimulatedDiskProfile &profile, uint32_t seed = 15445);
+
+  /** Waits for the asynchronous requests that are still in flight and stops the timer thread. */
+  ~SimulatedDiskManager() override;
+
+  DISALLOW_COPY_AND_MOVE(SimulatedDiskManager);
+
+  void ShutDown() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void WritePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void ReadPages(page_id_t first_page_id, char *const *pages_data, size_t num_pages) override;
+
+  void WritePageAsync(page_id_t page_id, const char *page_data, io_callback_fn callback) override;
+
+  void ReadPageAsync(page_id_t page_id, char *page_data, io_callback_fn callback) override;
+
+  void WaitForAsyncIO() override;
+
+  const char *GetAsyncIOBackend() override;
+
+  void Sync() override;
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int offset) override;
+
+  page_id_t AllocatePage() override;
+
+  void DeallocatePage(page_id_t page_id) override;
+
+  page_id_t ReserveExtent(size_t num_pages) override;
+
+  void AllocateReservedPage(page_id_t page_id) override;
+
+  bool IsPageAllocated(page_id_t page_id) override;
+
+  /** @return the number of operations that stalled */
+  uint64_t GetNumStalls() const { return num_stalls_; }
+
+ private:
+  /**
+   * Samples the latency of an operation that starts now and reserves its transfer on the bandwidth.
+   * @param latency the latency distribution of the operation
+   * @param num_bytes number of bytes the operation transfers
+   * @return the time the operation completes
+   */
+  std::chrono::steady_clock::time_point GetCompletionTime(const DiskLatency &latency, size_t num_bytes);
+
+  /** Queues the completion of an asynchronous request to run on the timer thread once it is due. */
+  void CompleteAt(std::chrono::steady_clock::time_point done, std::function<void()> completion);
+
+  /** Body of the timer thread, runs the queued completions in the order they are due. */
+  void RunCompletions();
+
+  DiskManager *disk_manager_;
+  SimulatedDiskProfile profile_;
+  // random latencies and stalls
+  std::mt19937 random_;
+  std::mutex random_latch_;
+  // time at which the transfers queued up so far are done
+  std::chrono::steady_clock::time_point bandwidth_free_;
+  std::mutex bandwidth_latch_;
+  std::atomic<uint64_t> num_stalls_{0};
+  // completions of asynchronous requests waiting for their time, earliest first
+  std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> completions_;
+  // asynchronous requests whose callback did not return yet
+  size_t num_pending_{0};
+  bool stop_{false};
+  std::mutex completions_latch_;
+  std::condition_variable completions_cv_;
+  std::thread timer_thread_;
+};
+
+}  // namespace bustub
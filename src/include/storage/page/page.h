@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 
@@ -23,36 +26,51 @@ namespace bustub {
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
- * pin count, dirty flag, page id, etc.
+ * pin count, dirty flag, page id, etc. The data itself lives in a separate PAGE_SIZE aligned buffer, so the buffer pool
+ * can keep the data of all its frames in one arena, apart from their book-keeping.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates a zeroed buffer for the page data. */
+  Page() : data_(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE))), owns_data_(true) { ResetMemory(); }
 
-  /** Default destructor. */
-  ~Page() = default;
+  /** Destructor. Frees the page data, unless it belongs to the buffer pool. */
+  ~Page() {
+    if (owns_data_) {
+      std::free(data_);
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
 
   /** @return the page id of this page */
-  inline page_id_t GetPageId() { return page_id_; }
+  inline page_id_t GetPageId() { return UnpackPageId(pin_state_.load()); }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() {
+    uint32_t pin_count = UnpackPinCount(pin_state_.load());
+    return pin_count == PIN_COUNT_LOCKED ? 0 : static_cast<int>(pin_count);
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The page version turns odd while the latch is held. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,6 +78,27 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start an optimistic read, which does not write any shared state. Everything read until the read is validated may
+   * be torn by a concurrent writer, so it must be bounds-checked and must not be acted upon before validation.
+   * @param[out] version the page version to validate against
+   * @return false if a writer currently holds the page latch, in which case the reader should take the read latch
+   */
+  inline bool TryOptimisticRLatch(uint64_t *version) {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /**
+   * Finish an optimistic read.
+   * @param version the version returned by TryOptimisticRLatch
+   * @return true if no writer latched the page since the read started, i.e. everything read is consistent
+   */
+  inline bool ValidateOptimisticRLatch(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -75,19 +114,98 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /**
+   * Constructor for the frames of the buffer pool manager, whose data lives in its frame arena.
+   * @param data a zeroed, PAGE_SIZE aligned buffer of PAGE_SIZE bytes that outlives the page
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) {}
+
+  /** Pin count of a frame that the buffer pool manager is evicting, deleting or writing back. It cannot be pinned. */
+  static constexpr uint32_t PIN_COUNT_LOCKED = UINT32_MAX;
+
+  // The page id is stored shifted by one, so that all-zero memory reads as an unpinned frame without a page.
+  static inline uint64_t PackPinState(page_id_t page_id, uint32_t pin_count) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(page_id + 1)) << 32 | pin_count;
+  }
+  static inline page_id_t UnpackPageId(uint64_t pin_state) { return static_cast<page_id_t>(pin_state >> 32) - 1; }
+  static inline uint32_t UnpackPinCount(uint64_t pin_state) { return static_cast<uint32_t>(pin_state); }
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
+  /** Sets the page id and the pin count. Only the buffer pool manager does this, under the latch of its shard. */
+  inline void SetPinState(page_id_t page_id, uint32_t pin_count) {
+    pin_state_.store(PackPinState(page_id, pin_count));
+  }
+
+  /**
+   * Adds a pin, but only while the frame holds the given page and is not locked. This is what lets the buffer pool
+   * manager pin resident pages without a latch.
+   * @param page_id the page the caller expects in this frame
+   * @param[out] first_pin true if the page was unpinned before
+   * @return false if the frame holds another page or is locked
+   */
+  inline bool TryPin(page_id_t page_id, bool *first_pin) {
+    uint64_t pin_state = pin_state_.load();
+    while (UnpackPageId(pin_state) == page_id && UnpackPinCount(pin_state) != PIN_COUNT_LOCKED) {
+      if (pin_state_.compare_exchange_weak(pin_state, pin_state + 1)) {
+        *first_pin = UnpackPinCount(pin_state) == 0;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Drops a pin of the given page. The dirty flag is raised before the pin is dropped, so whoever evicts or writes
+   * back the page afterwards sees it.
+   * @param page_id the page the caller expects in this frame
+   * @param is_dirty true if the caller modified the page
+   * @param[out] last_pin true if the page is unpinned now
+   * @return false if the frame holds another page, is locked or is not pinned
+   */
+  inline bool TryUnpin(page_id_t page_id, bool is_dirty, bool *last_pin) {
+    uint64_t pin_state = pin_state_.load();
+    while (UnpackPageId(pin_state) == page_id && UnpackPinCount(pin_state) != 0 &&
+           UnpackPinCount(pin_state) != PIN_COUNT_LOCKED) {
+      if (is_dirty) {
+        is_dirty_ = true;
+      }
+      if (pin_state_.compare_exchange_weak(pin_state, pin_state - 1)) {
+        *last_pin = UnpackPinCount(pin_state) == 1;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Locks an unpinned frame, so that no one can pin it until the buffer pool manager resets its pin state.
+   * @return false if the frame is pinned
+   */
+  inline bool TryLockFrame() {
+    uint64_t pin_state = pin_state_.load();
+    return UnpackPinCount(pin_state) == 0 &&
+           pin_state_.compare_exchange_strong(pin_state, PackPinState(UnpackPageId(pin_state), PIN_COUNT_LOCKED));
+  }
+
+  /** @return true if the frame is locked, i.e. it cannot be pinned until the buffer pool manager unlocks it */
+  inline bool IsFrameLocked() { return UnpackPinCount(pin_state_.load()) == PIN_COUNT_LOCKED; }
+
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  char *data_;
+  /** True if data_ was allocated by the page itself. */
+  bool owns_data_;
+  /** The ID of this page in the upper and its pin count in the lower half, changed together by atomic operations. */
+  std::atomic<uint64_t> pin_state_{PackPinState(INVALID_PAGE_ID, 0)};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** Number of times the page was pinned since it was loaded into this frame, ranks the pages of a warm snapshot. */
+  std::atomic<uint32_t> access_count_{0};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Page version for optimistic readers, bumped when the write latch is acquired and when it is released. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
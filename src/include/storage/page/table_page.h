@@ -122,6 +122,18 @@ class TablePage : public Page {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Read a tuple from a table without taking the page latch. The copy is only kept if no writer latched the page while
+   * it was being made.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple that was read
+   * @param txn transaction performing the read
+   * @param lock_manager the lock manager
+   * @param[out] result what GetTuple would have returned
+   * @return false if the optimistic read failed and the caller has to fall back to GetTuple under the read latch
+   */
+  bool GetTupleOptimistic(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager, bool *result);
+
   /** @return the rid of the first tuple in this page */
 
   /**
@@ -99,8 +99,13 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy optional buffer ring the iterator reads pages through, so that a large scan does not flood the
+   * buffer pool; it must outlive the iterator
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -109,10 +114,19 @@ class TableHeap {
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
  private:
+  /**
+   * Reads the next page pointer of a pinned table page, used to let the buffer pool read ahead along the page chain.
+   * @param page a pinned table page, read-latched by the caller
+   * @return the id of the next page of the table, INVALID_PAGE_ID for the last page
+   */
+  static page_id_t NextPageId(Page *page);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** Extent new pages of the table come from, only used while holding the write latch of the last page. */
+  PageExtent extent_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,12 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +28,156 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  running_ = true;
+  flush_thread_ = new std::thread(&LogManager::FlushLoop, this);
+  enable_logging = true;
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
+ * The log records still in the log buffer are flushed before the thread exits
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    running_ = false;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  // Flush reads flush_thread_ under the latch, and the waiters that outlived the thread have to give up
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    flush_thread_ = nullptr;
+  }
+  flushed_cv_.notify_all();
+  delete flush_thread;
+  enable_logging = false;
+}
+
+/*
+ * Swap the buffers and write the flush buffer out, on a request or after log_timeout
+ * The latch is not held during the write, so appenders keep filling the log buffer
+ * and every commit that arrives meanwhile goes out with the next write
+ */
+void LogManager::FlushLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait_for(lock, log_timeout, [this] { return flush_requested_ || !running_; });
+    flush_requested_ = false;
+    if (log_buffer_offset_ == 0) {
+      if (!running_) {
+        break;
+      }
+      continue;
+    }
+
+    // every lsn handed out so far is in the log buffer, lsns are assigned under the latch
+    lsn_t flush_lsn = next_lsn_ - 1;
+    size_t flush_size = log_buffer_offset_;
+    std::swap(log_buffer_, flush_buffer_);
+    log_buffer_offset_ = 0;
+    flushed_cv_.notify_all();
+
+    lock.unlock();
+    disk_manager_->WriteLog(flush_buffer_, static_cast<int>(flush_size));
+    lock.lock();
+
+    persistent_lsn_ = flush_lsn;
+    flushed_cv_.notify_all();
+  }
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
  *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
+ * A record that does not fit hands the log buffer to the flush thread and waits
+ * for the buffers to be swapped. A record larger than the whole log buffer, or a
+ * full log buffer without a flush thread to empty it, would wait forever, so
+ * both throw instead
+ */
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  if (log_record->GetSize() > LOG_BUFFER_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "log record of " + std::to_string(log_record->GetSize()) +
+                                                     " bytes does not fit into the log buffer");
+  }
+  std::unique_lock<std::mutex> lock(latch_);
+  while (log_buffer_offset_ + log_record->GetSize() > static_cast<size_t>(LOG_BUFFER_SIZE)) {
+    if (!running_) {
+      throw Exception(ExceptionType::INVALID, "log buffer is full and no flush thread is running");
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+  log_record->lsn_ = next_lsn_++;
+  SerializeLogRecord(log_record);
+  log_buffer_offset_ += log_record->GetSize();
+  return log_record->lsn_;
+}
+
+/*
+ * Wait until the log is persistent up to lsn, waking the flush thread up
+ * A page that was never logged may carry any lsn, only the lsns handed out so far are waited for
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (flush_thread_ == nullptr) {
+    return;
+  }
+  lsn = std::min(lsn, next_lsn_ - 1);
+  while (persistent_lsn_ < lsn && flush_thread_ != nullptr) {
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+/*
+ * First, serialize the must have fields (20 bytes in total), then the fields of
+ * the record type, tuples with their own serialize function
+ */
+void LogManager::SerializeLogRecord(LogRecord *log_record) {
+  char *pos = log_buffer_ + log_buffer_offset_;
+  memcpy(pos, log_record, LogRecord::HEADER_SIZE);
+  pos += LogRecord::HEADER_SIZE;
+
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record->insert_rid_, sizeof(RID));
+      log_record->insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record->delete_rid_, sizeof(RID));
+      log_record->delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record->page_id_, sizeof(page_id_t));
+      break;
+    default:
+      break;
+  }
+}
 
 }  // namespace bustub
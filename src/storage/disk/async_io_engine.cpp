@@ -0,0 +1,364 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_engine.cpp
+//
+// Identification: src/storage/disk/async_io_engine.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_io_engine.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+void AsyncIOEngine::BeginRequest() {
+  std::unique_lock<std::mutex> lock(in_flight_latch_);
+  in_flight_cv_.wait(lock, [&] { return in_flight_ < queue_depth_; });
+  ++in_flight_;
+}
+
+void AsyncIOEngine::EndRequest(const io_callback_fn &callback, bool success) {
+  if (callback) {
+    callback(success);
+  }
+  std::lock_guard<std::mutex> guard(in_flight_latch_);
+  --in_flight_;
+  in_flight_cv_.notify_all();
+}
+
+void AsyncIOEngine::Wait() {
+  std::unique_lock<std::mutex> lock(in_flight_latch_);
+  in_flight_cv_.wait(lock, [&] { return in_flight_ == 0; });
+}
+
+namespace {
+
+/**
+ * IoUringEngine submits requests to an io_uring instance. It talks to the kernel through the raw system calls, so it
+ * does not depend on liburing. A completion thread waits for completions, resubmits the rest of short transfers and
+ * runs the callbacks.
+ */
+class IoUringEngine : public AsyncIOEngine {
+ public:
+  IoUringEngine(int fd, size_t queue_depth, int ring_fd, const io_uring_params &params)
+      : AsyncIOEngine(queue_depth), fd_(fd), ring_fd_(ring_fd), slots_(queue_depth) {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    single_mmap_ = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap_) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap_ ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(static_cast<void *>(Map(sqes_size_, IORING_OFF_SQES)));
+    if (!IsValid()) {
+      return;
+    }
+
+    sq_tail_ = reinterpret_cast<unsigned *>(sq_ring_ + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq_ring_ + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq_ring_ + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned *>(cq_ring_ + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq_ring_ + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq_ring_ + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq_ring_ + params.cq_off.cqes);
+
+    for (size_t slot = 0; slot < slots_.size(); ++slot) {
+      free_slots_.push_back(slot);
+    }
+    completion_thread_ = std::thread(&IoUringEngine::CompletionLoop, this);
+  }
+
+  ~IoUringEngine() override {
+    if (IsValid()) {
+      Shutdown();
+    }
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && !single_mmap_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    close(ring_fd_);
+  }
+
+  /** Waits for the requests in flight and stops the completion thread. */
+  void Shutdown() {
+    Wait();
+    {
+      // A no-op tells the completion thread to stop.
+      std::lock_guard<std::mutex> guard(sq_latch_);
+      io_uring_sqe *sqe = NextSqe();
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = STOP_USER_DATA;
+      PushSqe();
+    }
+    completion_thread_.join();
+  }
+
+  /** @return true if the rings could be mapped */
+  bool IsValid() const { return sq_ring_ != nullptr && cq_ring_ != nullptr && sqes_ != nullptr; }
+
+  void Submit(AsyncIORequest request) override {
+    BeginRequest();
+    std::lock_guard<std::mutex> guard(sq_latch_);
+    size_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    slots_[slot].request_ = std::move(request);
+    slots_[slot].done_ = 0;
+    PrepareSlot(slot);
+  }
+
+  const char *GetName() const override { return "io_uring"; }
+
+ private:
+  /** user_data of the no-op that stops the completion thread. */
+  static constexpr uint64_t STOP_USER_DATA = UINT64_MAX;
+
+  /** A request in flight, together with the part of it that is done. */
+  struct Slot {
+    AsyncIORequest request_;
+    size_t done_;
+    iovec iov_;
+  };
+
+  char *Map(size_t size, off_t offset) {
+    void *ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return ring == MAP_FAILED ? nullptr : static_cast<char *>(ring);
+  }
+
+  /** Returns the next free submission queue entry, zeroed. The caller holds sq_latch_. */
+  io_uring_sqe *NextSqe() {
+    io_uring_sqe *sqe = &sqes_[*sq_tail_ & sq_mask_];
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    return sqe;
+  }
+
+  /** Publishes the entry returned by NextSqe and hands it to the kernel. The caller holds sq_latch_. */
+  void PushSqe() {
+    unsigned tail = *sq_tail_;
+    sq_array_[tail & sq_mask_] = tail & sq_mask_;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0 && errno == EINTR) {
+    }
+  }
+
+  /** Submits what is left of the request in a slot. The caller holds sq_latch_. */
+  void PrepareSlot(size_t slot) {
+    Slot &s = slots_[slot];
+    s.iov_.iov_base = s.request_.data_ + s.done_;
+    s.iov_.iov_len = s.request_.size_ - s.done_;
+    io_uring_sqe *sqe = NextSqe();
+    sqe->opcode = s.request_.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&s.iov_);
+    sqe->len = 1;
+    sqe->off = s.request_.offset_ + s.done_;
+    sqe->user_data = slot;
+    PushSqe();
+  }
+
+  void CompleteSlot(size_t slot, bool success) {
+    io_callback_fn callback = std::move(slots_[slot].request_.callback_);
+    {
+      std::lock_guard<std::mutex> guard(sq_latch_);
+      free_slots_.push_back(slot);
+    }
+    EndRequest(callback, success);
+  }
+
+  void CompletionLoop() {
+    bool stop = false;
+    while (!stop) {
+      if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+        continue;
+      }
+      unsigned head = *cq_head_;
+      unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != tail; ++head) {
+        io_uring_cqe cqe = cqes_[head & cq_mask_];
+        // Free the entry before the callback runs, a full completion queue would stall the ring.
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        if (cqe.user_data == STOP_USER_DATA) {
+          stop = true;
+          continue;
+        }
+        auto slot = static_cast<size_t>(cqe.user_data);
+        Slot &s = slots_[slot];
+        if (cqe.res < 0) {
+          CompleteSlot(slot, false);
+        } else if (cqe.res == 0) {
+          // The end of the file: a read gets zeroes for the rest, a write that makes no progress failed.
+          if (!s.request_.is_write_) {
+            memset(s.request_.data_ + s.done_, 0, s.request_.size_ - s.done_);
+          }
+          CompleteSlot(slot, !s.request_.is_write_);
+        } else if ((s.done_ += cqe.res) < s.request_.size_) {
+          std::lock_guard<std::mutex> guard(sq_latch_);
+          PrepareSlot(slot);
+        } else {
+          CompleteSlot(slot, true);
+        }
+      }
+    }
+  }
+
+  int fd_;
+  int ring_fd_;
+
+  size_t sq_ring_size_;
+  size_t cq_ring_size_;
+  size_t sqes_size_;
+  bool single_mmap_;
+  char *sq_ring_;
+  char *cq_ring_;
+  io_uring_sqe *sqes_;
+
+  unsigned *sq_tail_;
+  unsigned sq_mask_;
+  unsigned *sq_array_;
+  unsigned *cq_head_;
+  unsigned *cq_tail_;
+  unsigned cq_mask_;
+  io_uring_cqe *cqes_;
+
+  /** Protects the submission queue and the free slots. */
+  std::mutex sq_latch_;
+  std::vector<Slot> slots_;
+  std::vector<size_t> free_slots_;
+  std::thread completion_thread_;
+};
+
+/** ThreadPoolEngine has a pool of threads serve the requests with pread and pwrite. */
+class ThreadPoolEngine : public AsyncIOEngine {
+ public:
+  ThreadPoolEngine(int fd, size_t queue_depth, size_t num_threads) : AsyncIOEngine(queue_depth), fd_(fd) {
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads_.emplace_back(&ThreadPoolEngine::WorkerLoop, this);
+    }
+  }
+
+  ~ThreadPoolEngine() override {
+    Wait();
+    {
+      std::lock_guard<std::mutex> guard(queue_latch_);
+      stop_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Submit(AsyncIORequest request) override {
+    BeginRequest();
+    {
+      std::lock_guard<std::mutex> guard(queue_latch_);
+      queue_.push_back(std::move(request));
+    }
+    queue_cv_.notify_one();
+  }
+
+  const char *GetName() const override { return "thread pool"; }
+
+ private:
+  /** Serves a request. @return true if it succeeded */
+  bool Serve(const AsyncIORequest &request) {
+    size_t done = 0;
+    while (done < request.size_) {
+      ssize_t result = request.is_write_
+                           ? pwrite(fd_, request.data_ + done, request.size_ - done, request.offset_ + done)
+                           : pread(fd_, request.data_ + done, request.size_ - done, request.offset_ + done);
+      if (result < 0 && errno == EINTR) {
+        continue;
+      }
+      if (result <= 0) {
+        if (result < 0 || request.is_write_) {
+          return false;
+        }
+        memset(request.data_ + done, 0, request.size_ - done);
+        return true;
+      }
+      done += result;
+    }
+    return true;
+  }
+
+  void WorkerLoop() {
+    while (true) {
+      AsyncIORequest request;
+      {
+        std::unique_lock<std::mutex> lock(queue_latch_);
+        queue_cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        request = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      bool success = Serve(request);
+      EndRequest(request.callback_, success);
+    }
+  }
+
+  int fd_;
+  std::mutex queue_latch_;
+  std::condition_variable queue_cv_;
+  std::deque<AsyncIORequest> queue_;
+  bool stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace
+
+AsyncIOEngine *AsyncIOEngine::Create(int fd, size_t queue_depth, size_t num_threads) {
+  AsyncIOEngine *engine = CreateIoUring(fd, queue_depth);
+  return engine != nullptr ? engine : CreateThreadPool(fd, queue_depth, num_threads);
+}
+
+AsyncIOEngine *AsyncIOEngine::CreateIoUring(int fd, size_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  // io_uring_setup fails with ENOSYS on old kernels and with EPERM where a sandbox forbids it.
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+  if (ring_fd < 0) {
+    return nullptr;
+  }
+  if (params.sq_entries < queue_depth) {
+    close(ring_fd);
+    return nullptr;
+  }
+  auto *engine = new IoUringEngine(fd, queue_depth, ring_fd, params);
+  if (!engine->IsValid()) {
+    delete engine;
+    return nullptr;
+  }
+  return engine;
+}
+
+AsyncIOEngine *AsyncIOEngine::CreateThreadPool(int fd, size_t queue_depth, size_t num_threads) {
+  return new ThreadPoolEngine(fd, queue_depth, num_threads);
+}
+
+}  // namespace bustub
@@ -10,26 +10,135 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <chrono>  // NOLINT
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/compression_util.h"
+#include "common/util/hash_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Identifies a database file, it is stored at the start of the file header. */
+static constexpr uint32_t DB_FILE_MAGIC = 0x42545542;
+
+/** Start of the file header, the first page of a db file. */
+struct DbFileHeader {
+  uint32_t magic_;
+  /** PAGE_SIZE of the build that created the file. */
+  uint32_t page_size_;
+};
+
+/** Identifies a compressed page image, it is stored at the start of the image. */
+static constexpr uint32_t COMPRESSED_PAGE_MAGIC = 0x5A504742;
+
+/**
+ * Start of a compressed page image. It makes the image recognizable by its content, so the stored size map only tells
+ * how much to read and a map that lost its latest entries can't make a page unreadable.
+ */
+struct CompressedPageHeader {
+  uint32_t magic_;
+  /** Number of compressed bytes that follow the header. */
+  uint32_t size_;
+  /** Checksum of the compressed bytes. */
+  uint32_t checksum_;
+};
+static constexpr size_t COMPRESSED_PAGE_HEADER_SIZE = sizeof(CompressedPageHeader);
+/** Compressed page images are stored in whole disk sectors, as direct I/O requires. */
+static constexpr size_t COMPRESSED_PAGE_ALIGNMENT = 512;
+/**
+ * Flag of a stored size map entry, set for a page stored as a compressed image, whose number of sectors is in the
+ * other bits of the entry. An entry of 0 stands for a page stored as it is.
+ */
+static constexpr uint8_t STORED_PAGE_COMPRESSED = 0x80;
+static_assert(PAGE_SIZE / COMPRESSED_PAGE_ALIGNMENT <= STORED_PAGE_COMPRESSED, "stored size map entry too small");
+
+/** @return the checksum of the compressed bytes of an image */
+static uint32_t ImageChecksum(const char *data, size_t size) {
+  hash_t hash = HashUtil::HashBytes(data, size);
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+/**
+ * Encode a page for compressed storage, a page whose image would not free at least a file system block is stored as
+ * it is
+ * @return the number of bytes of the image to store, PAGE_SIZE for a page stored as it is
+ */
+static size_t EncodePage(const char *page_data, char *image, size_t block_size) {
+  size_t capacity = PAGE_SIZE - block_size - COMPRESSED_PAGE_HEADER_SIZE;
+  size_t size = CompressionUtil::Compress(page_data, PAGE_SIZE, image + COMPRESSED_PAGE_HEADER_SIZE, capacity);
+  if (size == 0) {
+    memcpy(image, page_data, PAGE_SIZE);
+    return PAGE_SIZE;
+  }
+  CompressedPageHeader header{COMPRESSED_PAGE_MAGIC, static_cast<uint32_t>(size),
+                              ImageChecksum(image + COMPRESSED_PAGE_HEADER_SIZE, size)};
+  memcpy(image, &header, sizeof(header));
+  size += COMPRESSED_PAGE_HEADER_SIZE;
+  size_t stored_size = (size + COMPRESSED_PAGE_ALIGNMENT - 1) / COMPRESSED_PAGE_ALIGNMENT * COMPRESSED_PAGE_ALIGNMENT;
+  memset(image + size, 0, stored_size - size);
+  return stored_size;
+}
+
+/**
+ * Decompress the compressed page image at the start of a page slot
+ * @return the number of bytes the image is stored in, 0 if the bytes read are no complete image with a matching
+ * checksum
+ */
+static size_t DecodePage(const char *image, size_t image_size, char *page_data) {
+  CompressedPageHeader header;
+  memcpy(&header, image, sizeof(header));
+  if (header.magic_ != COMPRESSED_PAGE_MAGIC || header.size_ > image_size - COMPRESSED_PAGE_HEADER_SIZE ||
+      header.checksum_ != ImageChecksum(image + COMPRESSED_PAGE_HEADER_SIZE, header.size_) ||
+      CompressionUtil::Decompress(image + COMPRESSED_PAGE_HEADER_SIZE, header.size_, page_data, PAGE_SIZE) !=
+          PAGE_SIZE) {
+    return 0;
+  }
+  size_t size = COMPRESSED_PAGE_HEADER_SIZE + header.size_;
+  return (size + COMPRESSED_PAGE_ALIGNMENT - 1) / COMPRESSED_PAGE_ALIGNMENT * COMPRESSED_PAGE_ALIGNMENT;
+}
+
+/** Byte offset of a data page in the database file. */
+static off_t PageOffset(page_id_t page_id) {
+  return static_cast<off_t>(PageAllocator::GetPhysicalPage(page_id)) * PAGE_SIZE;
+}
+
+/**
+ * @return an aligned page buffer private to the calling thread, to stage unaligned pages for direct I/O
+ */
+static char *StagingBuffer() {
+  thread_local std::unique_ptr<char, decltype(&free)> buffer(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)),
+                                                             &free);
+  return buffer.get();
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io, bool compress_pages, size_t block_size)
+    : compress_pages_(compress_pages), file_name_(db_file) {
   std::string::size_type n = file_name_.find('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -47,67 +156,469 @@ DiskManager::DiskManager(const std::string &db_file)
     // reopen with original mode
     log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   }
+  // the stream cannot sync, the log is synced through a descriptor of its own
+  log_fd_ = open(log_name_.c_str(), O_RDONLY);
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // create the db file if it does not exist
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ != -1;
+    // file systems such as tmpfs refuse O_DIRECT
+    if (db_fd_ == -1 && errno == EINVAL) {
+      LOG_DEBUG("direct I/O not supported, using the page cache");
+    }
+  }
+  if (db_fd_ == -1) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ == -1) {
+    LOG_DEBUG("can't open db file");
+  } else {
+    struct stat stat_buf;
+    if (block_size != 0) {
+      fs_block_size_ = block_size;
+    } else if (fstat(db_fd_, &stat_buf) == 0 && stat_buf.st_blksize > 0) {
+      fs_block_size_ = static_cast<size_t>(stat_buf.st_blksize);
+    }
+    // a compressed page frees whole blocks only, so with blocks larger than half a page no page would get smaller
+    if (compress_pages_ && 2 * fs_block_size_ > PAGE_SIZE) {
+      close(db_fd_);
+      db_fd_ = -1;
+      if (log_fd_ != -1) {
+        close(log_fd_);
+        log_fd_ = -1;
+      }
+      throw Exception(ExceptionType::INVALID, "page compression can't save space on " + file_name_ + ", it has " +
+                                                  std::to_string(fs_block_size_) + " byte blocks and " +
+                                                  std::to_string(PAGE_SIZE) + " byte pages");
+    }
+    LoadAllocator();
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  // a disk manager that is destroyed without being shut down still makes its pages and allocations durable
+  if (db_fd_ != -1) {
+    DiskManager::ShutDown();
+  }
+  delete async_io_;
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  // finish the asynchronous requests before the file goes away
+  delete async_io_;
+  async_io_ = nullptr;
+  if (db_fd_ != -1) {
+    Sync();
+    close(db_fd_);
+    db_fd_ = -1;
+  }
   log_io_.close();
+  if (log_fd_ != -1) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  auto start = std::chrono::steady_clock::now();
+  if (compress_pages_) {
+    WriteCompressedPage(page_id, page_data);
+    data_file_io_.RecordWrite(GetStoredPageSize(page_id), std::chrono::steady_clock::now() - start);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  WriteAt(PageOffset(page_id), page_data);
+  data_file_io_.RecordWrite(PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Compress a page and write the image in place of the page, the rest of its slot becomes a hole
+ */
+void DiskManager::WriteCompressedPage(page_id_t page_id, const char *page_data) {
+  char *image = StagingBuffer();
+  size_t stored_size = EncodePage(page_data, image, fs_block_size_);
+  off_t offset = PageOffset(page_id);
+  WriteAt(offset, image, stored_size);
+  PunchHole(offset + static_cast<off_t>(stored_size), PAGE_SIZE - stored_size);
+  SetStoredPageSize(page_id, stored_size);
+}
+
+/**
+ * Write a page image at the given offset of the disk file
+ */
+void DiskManager::WriteAt(off_t offset, const char *page_data, size_t size) {
+  if (NeedsStaging(page_data)) {
+    char *staging = StagingBuffer();
+    memcpy(staging, page_data, size);
+    page_data = staging;
+  }
+  size_t done = 0;
+  // pwrite may write less than asked for, so continue until the whole image is written
+  while (done < size) {
+    ssize_t written = pwrite(db_fd_, page_data + done, size - done, offset + static_cast<off_t>(done));
+    // check for I/O error
+    if (written <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    done += static_cast<size_t>(written);
+  }
+}
+
+/**
+ * Write a run of consecutive pages into disk file, split where a bitmap page interrupts the run
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) {
+  // compressed pages have images of different sizes, so they are written one by one
+  if (compress_pages_) {
+    for (size_t i = 0; i < num_pages; ++i) {
+      WritePage(static_cast<page_id_t>(first_page_id + i), pages_data[i]);
+    }
+    return;
+  }
+  size_t done = 0;
+  while (done < num_pages) {
+    auto page_id = static_cast<page_id_t>(first_page_id + done);
+    size_t count =
+        std::min<size_t>(num_pages - done, PageAllocator::PAGES_PER_GROUP - page_id % PageAllocator::PAGES_PER_GROUP);
+    WriteRun(page_id, pages_data + done, count);
+    done += count;
+  }
+}
+
+/**
+ * Write a run of consecutive pages of one group into disk file with as few pwritev calls as possible
+ */
+void DiskManager::WriteRun(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) {
+  std::vector<struct iovec> iov(num_pages);
+  // direct I/O stages unaligned pages through an aligned copy
+  std::unique_ptr<char, decltype(&free)> staging(nullptr, &free);
+  for (size_t i = 0; i < num_pages; ++i) {
+    iov[i].iov_base = const_cast<char *>(pages_data[i]);
+    iov[i].iov_len = PAGE_SIZE;
+    if (NeedsStaging(pages_data[i])) {
+      if (staging == nullptr) {
+        staging.reset(static_cast<char *>(aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE)));
+      }
+      iov[i].iov_base = memcpy(staging.get() + i * PAGE_SIZE, pages_data[i], PAGE_SIZE);
+    }
+  }
+  off_t offset = PageOffset(first_page_id);
+  size_t done = 0;
+  while (done < num_pages) {
+    int count = static_cast<int>(std::min<size_t>(num_pages - done, IOV_MAX));
+    auto start = std::chrono::steady_clock::now();
+    ssize_t written = pwritev(db_fd_, &iov[done], count, offset);
+    data_file_io_.RecordWrite(std::max<ssize_t>(written, 0), std::chrono::steady_clock::now() - start);
+    // check for I/O error
+    if (written < 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    // a short write can stop in the middle of a page, so resume the partially written page
+    size_t full_pages = static_cast<size_t>(written) / PAGE_SIZE;
+    size_t remainder = static_cast<size_t>(written) % PAGE_SIZE;
+    done += full_pages;
+    offset += static_cast<off_t>(full_pages) * PAGE_SIZE;
+    if (remainder != 0) {
+      iov[done].iov_base = static_cast<char *>(iov[done].iov_base) + remainder;
+      iov[done].iov_len -= remainder;
+      offset += static_cast<off_t>(remainder);
+      if (pwritev(db_fd_, &iov[done], 1, offset) != static_cast<ssize_t>(iov[done].iov_len)) {
+        LOG_DEBUG("I/O error while writing");
+        return;
+      }
+      data_file_io_.bytes_written_ += iov[done].iov_len;
+      offset += static_cast<off_t>(iov[done].iov_len);
+      done += 1;
+    }
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+  off_t offset = PageOffset(page_id);
+  struct stat stat_buf;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (fstat(db_fd_, &stat_buf) != 0 || offset > stat_buf.st_size) {
     LOG_DEBUG("I/O error while reading");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  if (compress_pages_) {
+    ReadCompressedPage(page_id, page_data);
+    data_file_io_.RecordRead(GetStoredPageSize(page_id), std::chrono::steady_clock::now() - start);
+    return;
+  }
+  ReadAt(offset, page_data);
+  data_file_io_.RecordRead(PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Read the stored image of a page and decompress it
+ */
+void DiskManager::ReadCompressedPage(page_id_t page_id, char *page_data) {
+  char *image = StagingBuffer();
+  size_t stored_size = GetStoredPageSize(page_id);
+  ReadAt(PageOffset(page_id), image, stored_size);
+  DecodeStoredPage(page_id, image, stored_size, page_data);
+}
+
+/**
+ * Turn the bytes read from the slot of a page into the page. The stored size map only tells how many bytes to read:
+ * if they are no complete image, as when the map lost its latest entries in a crash, the whole slot is read and
+ * recognized by its content, and the map entry is corrected.
+ */
+void DiskManager::DecodeStoredPage(page_id_t page_id, char *image, size_t image_size, char *page_data) {
+  size_t stored_size = DecodePage(image, image_size, page_data);
+  if (stored_size == 0 && image_size < PAGE_SIZE) {
+    ReadAt(PageOffset(page_id), image, PAGE_SIZE);
+    stored_size = DecodePage(image, PAGE_SIZE, page_data);
+  }
+  if (stored_size != 0) {
+    SetStoredPageSize(page_id, stored_size);
+    return;
+  }
+  // a slot without an image holds the page as it is
+  memcpy(page_data, image, PAGE_SIZE);
+  SetStoredPageSize(page_id, PAGE_SIZE);
+}
+
+/**
+ * Read a page image at the given offset of the disk file
+ */
+void DiskManager::ReadAt(off_t offset, char *page_data, size_t size) {
+  if (NeedsStaging(page_data)) {
+    char *staging = StagingBuffer();
+    ReadAt(offset, staging, size);
+    memcpy(page_data, staging, size);
+    return;
+  }
+  size_t done = 0;
+  // pread may read less than asked for, so continue until the whole image is read or the file ends
+  while (done < size) {
+    ssize_t read_count = pread(db_fd_, page_data + done, size - done, offset + static_cast<off_t>(done));
+    if (read_count < 0) {
+      LOG_DEBUG("I/O error while reading");
+      break;
+    }
+    if (read_count == 0) {
+      LOG_DEBUG("Read less than a page");
+      break;
+    }
+    done += static_cast<size_t>(read_count);
+  }
+  // if file ends before reading the whole image
+  memset(page_data + done, 0, size - done);
+}
+
+/**
+ * Read a run of consecutive pages from disk file, split where a bitmap page interrupts the run
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, char *const *pages_data, size_t num_pages) {
+  // compressed pages have images of different sizes, so they are read one by one
+  if (compress_pages_) {
+    for (size_t i = 0; i < num_pages; ++i) {
+      auto page_id = static_cast<page_id_t>(first_page_id + i);
+      auto start = std::chrono::steady_clock::now();
+      ReadCompressedPage(page_id, pages_data[i]);
+      data_file_io_.RecordRead(GetStoredPageSize(page_id), std::chrono::steady_clock::now() - start);
+    }
+    return;
+  }
+  size_t done = 0;
+  while (done < num_pages) {
+    auto page_id = static_cast<page_id_t>(first_page_id + done);
+    size_t count =
+        std::min<size_t>(num_pages - done, PageAllocator::PAGES_PER_GROUP - page_id % PageAllocator::PAGES_PER_GROUP);
+    ReadRun(page_id, pages_data + done, count);
+    done += count;
+  }
+}
+
+/**
+ * Read a run of consecutive pages of one group from disk file with as few preadv calls as possible
+ */
+void DiskManager::ReadRun(page_id_t first_page_id, char *const *pages_data, size_t num_pages) {
+  std::vector<struct iovec> iov(num_pages);
+  // direct I/O reads unaligned pages into an aligned staging area, they are copied out at the end
+  std::unique_ptr<char, decltype(&free)> staging(nullptr, &free);
+  for (size_t i = 0; i < num_pages; ++i) {
+    iov[i].iov_base = pages_data[i];
+    iov[i].iov_len = PAGE_SIZE;
+    if (NeedsStaging(pages_data[i])) {
+      if (staging == nullptr) {
+        staging.reset(static_cast<char *>(aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE)));
+      }
+      iov[i].iov_base = staging.get() + i * PAGE_SIZE;
+    }
+  }
+  off_t offset = PageOffset(first_page_id);
+  size_t done = 0;
+  while (done < num_pages) {
+    int count = static_cast<int>(std::min<size_t>(num_pages - done, IOV_MAX));
+    auto start = std::chrono::steady_clock::now();
+    ssize_t read_count = preadv(db_fd_, &iov[done], count, offset);
+    data_file_io_.RecordRead(std::max<ssize_t>(read_count, 0), std::chrono::steady_clock::now() - start);
+    if (read_count < 0) {
+      LOG_DEBUG("I/O error while reading");
+      break;
+    }
+    if (read_count == 0) {
       LOG_DEBUG("Read less than a page");
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      break;
+    }
+    // a short read can stop in the middle of a page, so resume the partially read page
+    size_t full_pages = static_cast<size_t>(read_count) / PAGE_SIZE;
+    size_t remainder = static_cast<size_t>(read_count) % PAGE_SIZE;
+    done += full_pages;
+    offset += static_cast<off_t>(read_count);
+    if (remainder != 0) {
+      iov[done].iov_base = static_cast<char *>(iov[done].iov_base) + remainder;
+      iov[done].iov_len -= remainder;
+    }
+  }
+  // zero whatever lies past the end of the file
+  for (; done < num_pages; ++done) {
+    memset(iov[done].iov_base, 0, iov[done].iov_len);
+  }
+  if (staging != nullptr) {
+    for (size_t i = 0; i < num_pages; ++i) {
+      if (NeedsStaging(pages_data[i])) {
+        memcpy(pages_data[i], staging.get() + i * PAGE_SIZE, PAGE_SIZE);
+      }
+    }
+  }
+}
+
+/**
+ * Hand a page write to the asynchronous I/O engine
+ */
+void DiskManager::WritePageAsync(page_id_t page_id, const char *page_data, io_callback_fn callback) {
+  off_t offset = PageOffset(page_id);
+  size_t size = PAGE_SIZE;
+  if (compress_pages_ || NeedsStaging(page_data)) {
+    // the compressed image or the staging copy lives until the write completed
+    auto *image = static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+    if (compress_pages_) {
+      size = EncodePage(page_data, image, fs_block_size_);
+      PunchHole(offset + static_cast<off_t>(size), PAGE_SIZE - size);
+      SetStoredPageSize(page_id, size);
+    } else {
+      memcpy(image, page_data, PAGE_SIZE);
+    }
+    page_data = image;
+    callback = [image, callback = std::move(callback)](bool success) {
+      free(image);
+      if (callback) {
+        callback(success);
+      }
+    };
+  }
+  // the write is recorded once it completed
+  auto start = std::chrono::steady_clock::now();
+  callback = [this, size, start, callback = std::move(callback)](bool success) {
+    data_file_io_.RecordWrite(size, std::chrono::steady_clock::now() - start);
+    if (callback) {
+      callback(success);
     }
+  };
+  GetAsyncIOEngine()->Submit({true, const_cast<char *>(page_data), size, offset, std::move(callback)});
+}
+
+/**
+ * Hand a page read to the asynchronous I/O engine
+ */
+void DiskManager::ReadPageAsync(page_id_t page_id, char *page_data, io_callback_fn callback) {
+  size_t size = compress_pages_ ? GetStoredPageSize(page_id) : PAGE_SIZE;
+  if (compress_pages_ || NeedsStaging(page_data)) {
+    // the image is read into an aligned buffer, and decoded or copied out before the callback runs
+    auto *image = static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+    callback = [this, page_id, image, page_data, size, callback = std::move(callback)](bool success) {
+      if (compress_pages_) {
+        DecodeStoredPage(page_id, image, size, page_data);
+      } else {
+        memcpy(page_data, image, PAGE_SIZE);
+      }
+      free(image);
+      if (callback) {
+        callback(success);
+      }
+    };
+    page_data = image;
+  }
+  // the read is recorded once it completed
+  auto start = std::chrono::steady_clock::now();
+  callback = [this, size, start, callback = std::move(callback)](bool success) {
+    data_file_io_.RecordRead(size, std::chrono::steady_clock::now() - start);
+    if (callback) {
+      callback(success);
+    }
+  };
+  GetAsyncIOEngine()->Submit({false, page_data, size, PageOffset(page_id), std::move(callback)});
+}
+
+void DiskManager::WaitForAsyncIO() {
+  AsyncIOEngine *async_io;
+  {
+    std::lock_guard<std::mutex> guard(async_io_latch_);
+    async_io = async_io_;
+  }
+  if (async_io != nullptr) {
+    async_io->Wait();
+  }
+}
+
+const char *DiskManager::GetAsyncIOBackend() { return GetAsyncIOEngine()->GetName(); }
+
+AsyncIOEngine *DiskManager::GetAsyncIOEngine() {
+  std::lock_guard<std::mutex> guard(async_io_latch_);
+  if (async_io_ == nullptr) {
+    async_io_ = AsyncIOEngine::Create(db_fd_, ASYNC_IO_QUEUE_DEPTH, ASYNC_IO_THREADS);
   }
+  return async_io_;
+}
+
+/**
+ * Make all written pages durable
+ */
+void DiskManager::Sync() {
+  std::lock_guard<std::mutex> guard(sync_latch_);
+  // the bitmap and stored size map pages become durable together with the pages they describe
+  for (auto &[group, bitmap] : allocator_.TakeDirtyGroups()) {
+    WriteAt(static_cast<off_t>(PageAllocator::GetBitmapPhysicalPage(group)) * PAGE_SIZE, bitmap.data());
+  }
+  std::vector<std::pair<size_t, std::vector<char>>> dirty_map_pages;
+  {
+    std::lock_guard<std::mutex> map_guard(stored_sizes_latch_);
+    for (size_t map_page = 0; map_page < stored_sizes_dirty_.size(); ++map_page) {
+      if (stored_sizes_dirty_[map_page]) {
+        auto begin = stored_sizes_.begin() + static_cast<std::ptrdiff_t>(map_page * PAGE_SIZE);
+        dirty_map_pages.emplace_back(map_page, std::vector<char>(begin, begin + PAGE_SIZE));
+        stored_sizes_dirty_[map_page] = false;
+      }
+    }
+  }
+  for (auto &[map_page, entries] : dirty_map_pages) {
+    size_t group = map_page / PageAllocator::SIZE_MAP_PAGES_PER_GROUP;
+    size_t physical_page =
+        PageAllocator::GetSizeMapPhysicalPage(group) + map_page % PageAllocator::SIZE_MAP_PAGES_PER_GROUP;
+    WriteAt(static_cast<off_t>(physical_page) * PAGE_SIZE, entries.data());
+  }
+  auto start = std::chrono::steady_clock::now();
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+  data_file_io_.RecordSync(std::chrono::steady_clock::now() - start);
 }
 
 /**
@@ -119,7 +630,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
   assert(log_data != buffer_used);
   buffer_used = log_data;
 
-  if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
+  if (size == 0) {  // no effect on the log writes if log buffer is empty
     return;
   }
 
@@ -130,17 +641,24 @@ void DiskManager::WriteLog(char *log_data, int size) {
     assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
   }
 
-  num_flushes_ += 1;
+  auto start = std::chrono::steady_clock::now();
   // sequence write
   log_io_.write(log_data, size);
 
   // check for I/O error
   if (log_io_.bad()) {
     LOG_DEBUG("I/O error while writing log");
+    log_file_io_.RecordWrite(0, std::chrono::steady_clock::now() - start);
     return;
   }
   // needs to flush to keep disk file in sync
   log_io_.flush();
+  log_file_io_.RecordWrite(size, std::chrono::steady_clock::now() - start);
+  start = std::chrono::steady_clock::now();
+  if (log_fd_ != -1 && fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
+  log_file_io_.RecordSync(std::chrono::steady_clock::now() - start);
   flush_log_ = false;
 }
 
@@ -155,10 +673,12 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
+  auto start = std::chrono::steady_clock::now();
   log_io_.seekp(offset);
   log_io_.read(log_data, size);
   // if log file ends before reading "size"
   int read_count = log_io_.gcount();
+  log_file_io_.RecordRead(read_count, std::chrono::steady_clock::now() - start);
   if (read_count < size) {
     log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
@@ -169,32 +689,164 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Reuses the lowest deallocated page before growing the file
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage() { return allocator_.Allocate(); }
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * The page is handed out again by a later allocation
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) { allocator_.Deallocate(page_id); }
+
+/**
+ * Reserve consecutive pages for one table or index
+ */
+page_id_t DiskManager::ReserveExtent(size_t num_pages) { return allocator_.Reserve(num_pages); }
+
+/**
+ * Allocate a page out of a reserved extent
+ */
+void DiskManager::AllocateReservedPage(page_id_t page_id) { allocator_.AllocateReserved(page_id); }
+
+/**
+ * Returns true if the page is allocated
+ */
+bool DiskManager::IsPageAllocated(page_id_t page_id) { return allocator_.IsAllocated(page_id); }
 
 /**
  * Returns number of flushes made so far
  */
-int DiskManager::GetNumFlushes() const { return num_flushes_; }
+int DiskManager::GetNumFlushes() const { return static_cast<int>(log_file_io_.writes_.load()); }
 
 /**
  * Returns number of Writes made so far
  */
-int DiskManager::GetNumWrites() const { return num_writes_; }
+int DiskManager::GetNumWrites() const { return static_cast<int>(data_file_io_.writes_.load()); }
+
+/**
+ * Returns number of Reads made so far
+ */
+int DiskManager::GetNumReads() const { return static_cast<int>(data_file_io_.reads_.load()); }
+
+/**
+ * Returns number of syncs of the db file made so far
+ */
+int DiskManager::GetNumSyncs() const { return static_cast<int>(data_file_io_.syncs_.load()); }
+
+/**
+ * Returns a snapshot of the I/O counters of the db file and the log file
+ */
+DiskManagerMetrics DiskManager::GetMetrics() const {
+  DiskManagerMetrics metrics;
+  metrics.data_.Add(data_file_io_);
+  metrics.log_.Add(log_file_io_);
+  return metrics;
+}
 
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Private helper function to write the file header of a new db file, or to check the one of an existing file, and to
+ * read the bitmap pages back
+ */
+void DiskManager::LoadAllocator() {
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  size_t num_physical_pages = (static_cast<size_t>(stat_buf.st_size) + PAGE_SIZE - 1) / PAGE_SIZE;
+  char *page = StagingBuffer();
+  DbFileHeader header{DB_FILE_MAGIC, PAGE_SIZE};
+  if (num_physical_pages == 0) {
+    memset(page, 0, PAGE_SIZE);
+    memcpy(page, &header, sizeof(header));
+    WriteAt(0, page);
+    return;
+  }
+  // the header fits into the smallest page size, so it reads the same whatever the page size of the file
+  ReadAt(0, page);
+  memcpy(&header, page, sizeof(header));
+  // pages of a foreign file would be read and overwritten as if they were ours
+  if (header.magic_ != DB_FILE_MAGIC) {
+    close(db_fd_);
+    db_fd_ = -1;
+    throw Exception(ExceptionType::MISMATCH_TYPE, file_name_ + " is not a db file");
+  }
+  if (header.page_size_ != PAGE_SIZE) {
+    close(db_fd_);
+    db_fd_ = -1;
+    throw Exception(ExceptionType::MISMATCH_TYPE, file_name_ + " has " + std::to_string(header.page_size_) +
+                                                      " byte pages, this build uses " + std::to_string(PAGE_SIZE));
+  }
+  for (size_t group = 0; PageAllocator::GetBitmapPhysicalPage(group) < num_physical_pages; ++group) {
+    ReadAt(static_cast<off_t>(PageAllocator::GetBitmapPhysicalPage(group)) * PAGE_SIZE, page);
+    allocator_.LoadGroup(page);
+    if (!compress_pages_) {
+      continue;
+    }
+    // map pages that were never written read as zeroes, their pages are stored as they are
+    for (size_t i = 0; i < PageAllocator::SIZE_MAP_PAGES_PER_GROUP; ++i) {
+      ReadAt(static_cast<off_t>(PageAllocator::GetSizeMapPhysicalPage(group) + i) * PAGE_SIZE, page);
+      stored_sizes_.insert(stored_sizes_.end(), page, page + PAGE_SIZE);
+      stored_sizes_dirty_.push_back(false);
+    }
+  }
+}
+
+/**
+ * Returns the number of bytes the image of a page takes in the db file
+ */
+size_t DiskManager::GetStoredPageSize(page_id_t page_id) {
+  uint8_t entry = GetStoredSizeEntry(page_id);
+  return (entry & STORED_PAGE_COMPRESSED) != 0 ? (entry & ~STORED_PAGE_COMPRESSED) * COMPRESSED_PAGE_ALIGNMENT
+                                               : PAGE_SIZE;
+}
+
+uint8_t DiskManager::GetStoredSizeEntry(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(stored_sizes_latch_);
+  auto index = static_cast<size_t>(page_id);
+  return index < stored_sizes_.size() ? stored_sizes_[index] : 0;
+}
+
+void DiskManager::SetStoredPageSize(page_id_t page_id, size_t stored_size) {
+  auto entry = static_cast<uint8_t>(
+      stored_size < PAGE_SIZE ? STORED_PAGE_COMPRESSED | stored_size / COMPRESSED_PAGE_ALIGNMENT : 0);
+  std::lock_guard<std::mutex> guard(stored_sizes_latch_);
+  auto index = static_cast<size_t>(page_id);
+  if (index >= stored_sizes_.size()) {
+    // the map grows by whole groups, like the file
+    size_t num_groups = index / PageAllocator::PAGES_PER_GROUP + 1;
+    stored_sizes_.resize(num_groups * PageAllocator::PAGES_PER_GROUP, 0);
+    stored_sizes_dirty_.resize(num_groups * PageAllocator::SIZE_MAP_PAGES_PER_GROUP, false);
+  }
+  if (stored_sizes_[index] != entry) {
+    stored_sizes_[index] = entry;
+    stored_sizes_dirty_[index / PAGE_SIZE] = true;
+  }
+}
+
+/**
+ * Private helper function to free the file system blocks of a range of the db file, the range reads as zeroes after
+ */
+void DiskManager::PunchHole(off_t offset, size_t size) {
+  // only whole blocks are freed, zeroing part of a block would just cost another write
+  auto block_size = static_cast<off_t>(fs_block_size_);
+  off_t begin = (offset + block_size - 1) / block_size * block_size;
+  off_t end = (offset + static_cast<off_t>(size)) / block_size * block_size;
+  if (begin < end && fallocate(db_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, begin, end - begin) != 0) {
+    LOG_DEBUG("can't punch a hole into the db file");
+  }
+}
+
+bool DiskManager::NeedsStaging(const char *buffer) const {
+  return direct_io_ && reinterpret_cast<uintptr_t>(buffer) % PAGE_SIZE != 0;
+}
+
 /**
  * Private helper function to get disk file size
  */
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_metrics.cpp
+//
+// Identification: src/storage/disk/disk_manager_metrics.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_metrics.h"
+
+#include <sstream>
+
+namespace bustub {
+
+void FileIOMetrics::Add(const FileIOCounters &counters) {
+  reads_ += counters.reads_.load(std::memory_order_relaxed);
+  writes_ += counters.writes_.load(std::memory_order_relaxed);
+  bytes_read_ += counters.bytes_read_.load(std::memory_order_relaxed);
+  bytes_written_ += counters.bytes_written_.load(std::memory_order_relaxed);
+  syncs_ += counters.syncs_.load(std::memory_order_relaxed);
+  read_latency_.Merge(counters.read_latency_.GetSnapshot());
+  write_latency_.Merge(counters.write_latency_.GetSnapshot());
+  sync_latency_.Merge(counters.sync_latency_.GetSnapshot());
+}
+
+std::string DiskManagerMetrics::ToString() const {
+  std::ostringstream os;
+  auto dump_histogram = [&os](const std::string &name, const LatencyHistogramSnapshot &histogram) {
+    os << name << "_mean_ns " << histogram.GetMean() << "\n"
+       << name << "_p50_ns " << histogram.GetPercentile(50) << "\n"
+       << name << "_p99_ns " << histogram.GetPercentile(99) << "\n"
+       << name << "_p999_ns " << histogram.GetPercentile(99.9) << "\n";
+  };
+  auto dump_file = [&os, &dump_histogram](const std::string &file, const FileIOMetrics &metrics) {
+    os << file << "_reads " << metrics.reads_ << "\n"
+       << file << "_writes " << metrics.writes_ << "\n"
+       << file << "_bytes_read " << metrics.bytes_read_ << "\n"
+       << file << "_bytes_written " << metrics.bytes_written_ << "\n"
+       << file << "_syncs " << metrics.syncs_ << "\n";
+    dump_histogram(file + "_read", metrics.read_latency_);
+    dump_histogram(file + "_write", metrics.write_latency_);
+    dump_histogram(file + "_sync", metrics.sync_latency_);
+  };
+  dump_file("data", data_);
+  dump_file("log", log_);
+  return os.str();
+}
+
+}  // namespace bustub
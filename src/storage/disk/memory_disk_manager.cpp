@@ -0,0 +1,192 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_disk_manager.cpp
+//
+// Identification: src/storage/disk/memory_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/memory_disk_manager.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>  // NOLINT
+#include <cstring>
+
+namespace bustub {
+
+MemoryDiskManager::~MemoryDiskManager() {
+  for (char *page : pages_) {
+    delete[] page;
+  }
+}
+
+/**
+ * Copy a page into the page store
+ */
+void MemoryDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  StorePages(page_id, &page_data, 1);
+  data_file_io_.RecordWrite(PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Copy a run of pages into the page store, counted as one write like a vectored write
+ */
+void MemoryDiskManager::WritePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) {
+  auto start = std::chrono::steady_clock::now();
+  StorePages(first_page_id, pages_data, num_pages);
+  data_file_io_.RecordWrite(num_pages * PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Copy a page out of the page store
+ */
+void MemoryDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  pages_latch_.RLock();
+  LoadPage(page_id, page_data);
+  pages_latch_.RUnlock();
+  data_file_io_.RecordRead(PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Copy a run of pages out of the page store, counted as one read like a vectored read
+ */
+void MemoryDiskManager::ReadPages(page_id_t first_page_id, char *const *pages_data, size_t num_pages) {
+  auto start = std::chrono::steady_clock::now();
+  pages_latch_.RLock();
+  for (size_t i = 0; i < num_pages; ++i) {
+    LoadPage(first_page_id + static_cast<page_id_t>(i), pages_data[i]);
+  }
+  pages_latch_.RUnlock();
+  data_file_io_.RecordRead(num_pages * PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+void MemoryDiskManager::WritePageAsync(page_id_t page_id, const char *page_data, io_callback_fn callback) {
+  WritePage(page_id, page_data);
+  if (callback) {
+    callback(true);
+  }
+}
+
+void MemoryDiskManager::ReadPageAsync(page_id_t page_id, char *page_data, io_callback_fn callback) {
+  ReadPage(page_id, page_data);
+  if (callback) {
+    callback(true);
+  }
+}
+
+/**
+ * Pages in memory are as durable as they get
+ */
+void MemoryDiskManager::Sync() { data_file_io_.RecordSync(std::chrono::nanoseconds(0)); }
+
+/**
+ * Append the log buffer to the log
+ */
+void MemoryDiskManager::WriteLog(char *log_data, int size) {
+  if (size == 0) {  // no effect on the log writes if log buffer is empty
+    return;
+  }
+
+  flush_log_ = true;
+
+  if (flush_log_f_ != nullptr) {
+    // used for checking non-blocking flushing
+    assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> guard(log_latch_);
+    log_.insert(log_.end(), log_data, log_data + size);
+  }
+  log_file_io_.RecordWrite(size, std::chrono::steady_clock::now() - start);
+  flush_log_ = false;
+}
+
+/**
+ * Read the log at an offset, the part past the end of the log as zeroes
+ * @return: false means already reach the end
+ */
+bool MemoryDiskManager::ReadLog(char *log_data, int size, int offset) {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  auto start = static_cast<size_t>(offset);
+  if (offset < 0 || start >= log_.size()) {
+    return false;
+  }
+  size_t read_count = std::min(static_cast<size_t>(size), log_.size() - start);
+  memcpy(log_data, log_.data() + start, read_count);
+  memset(log_data + read_count, 0, size - read_count);
+  log_file_io_.RecordRead(read_count, std::chrono::nanoseconds(0));
+  return true;
+}
+
+/**
+ * Returns the number of pages in the page store
+ */
+size_t MemoryDiskManager::GetNumStoredPages() {
+  pages_latch_.RLock();
+  size_t num_pages = std::count_if(pages_.begin(), pages_.end(), [](char *page) { return page != nullptr; });
+  pages_latch_.RUnlock();
+  return num_pages;
+}
+
+void MemoryDiskManager::StorePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) {
+  // pages that are in the page store already are overwritten in place under their page latch, which only needs the
+  // page store latch in read mode
+  size_t stored = 0;
+  pages_latch_.RLock();
+  for (; stored < num_pages; ++stored) {
+    auto page_id = first_page_id + static_cast<page_id_t>(stored);
+    auto index = static_cast<size_t>(page_id);
+    if (index >= pages_.size() || pages_[index] == nullptr) {
+      break;
+    }
+    ReaderWriterLatch *page_latch = GetPageLatch(page_id);
+    page_latch->WLock();
+    memcpy(pages_[index], pages_data[stored], PAGE_SIZE);
+    page_latch->WUnlock();
+  }
+  pages_latch_.RUnlock();
+  if (stored == num_pages) {
+    return;
+  }
+  // the rest of the run needs new pages, and maybe a larger page store
+  pages_latch_.WLock();
+  for (; stored < num_pages; ++stored) {
+    StorePage(first_page_id + static_cast<page_id_t>(stored), pages_data[stored]);
+  }
+  pages_latch_.WUnlock();
+}
+
+void MemoryDiskManager::StorePage(page_id_t page_id, const char *page_data) {
+  auto index = static_cast<size_t>(page_id);
+  if (index >= pages_.size()) {
+    // grow geometrically, so a growing database does not move the page table on every new page
+    pages_.resize(std::max(index + 1, pages_.size() * 2), nullptr);
+  }
+  if (pages_[index] == nullptr) {
+    pages_[index] = new char[PAGE_SIZE];
+  }
+  memcpy(pages_[index], page_data, PAGE_SIZE);
+}
+
+void MemoryDiskManager::LoadPage(page_id_t page_id, char *page_data) {
+  auto index = static_cast<size_t>(page_id);
+  if (index >= pages_.size() || pages_[index] == nullptr) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  ReaderWriterLatch *page_latch = GetPageLatch(page_id);
+  page_latch->RLock();
+  memcpy(page_data, pages_[index], PAGE_SIZE);
+  page_latch->RUnlock();
+}
+
+}  // namespace bustub
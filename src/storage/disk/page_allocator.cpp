@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_allocator.cpp
+//
+// Identification: src/storage/disk/page_allocator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_allocator.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void PageAllocator::LoadGroup(const char *bitmap_data) {
+  std::lock_guard<std::mutex> guard(latch_);
+  AddGroup();
+  std::copy(bitmap_data, bitmap_data + PAGE_SIZE, groups_.back().begin());
+  for (size_t i = 0; i < PAGE_SIZE; ++i) {
+    num_allocated_ += std::bitset<8>(static_cast<uint8_t>(bitmap_data[i])).count();
+  }
+}
+
+page_id_t PageAllocator::Allocate() {
+  std::lock_guard<std::mutex> guard(latch_);
+  page_id_t page_id = first_free_hint_;
+  while (true) {
+    auto group = static_cast<size_t>(page_id / PAGES_PER_GROUP);
+    if (group == groups_.size()) {
+      // Every group is full, the file grows by a new one.
+      AddGroup();
+    }
+    auto &bitmap = groups_[group];
+    auto &reserved = reserved_[group];
+    // Skip over full bytes, then take the lowest free bit of the first one that is not.
+    size_t byte = page_id % PAGES_PER_GROUP / 8;
+    while (byte < PAGE_SIZE && static_cast<uint8_t>(bitmap[byte] | reserved[byte]) == 0xFF) {
+      byte++;
+    }
+    if (byte == PAGE_SIZE) {
+      page_id = static_cast<page_id_t>(group + 1) * PAGES_PER_GROUP;
+      continue;
+    }
+    int bit = 0;
+    while (((bitmap[byte] | reserved[byte]) >> bit & 1) != 0) {
+      bit++;
+    }
+    bitmap[byte] = static_cast<char>(bitmap[byte] | 1 << bit);
+    dirty_[group] = true;
+    num_allocated_++;
+    page_id = static_cast<page_id_t>(group * PAGES_PER_GROUP + byte * 8 + bit);
+    first_free_hint_ = page_id + 1;
+    return page_id;
+  }
+}
+
+page_id_t PageAllocator::Reserve(size_t num_pages) {
+  BUSTUB_ASSERT(num_pages > 0 && num_pages <= static_cast<size_t>(PAGES_PER_GROUP), "Invalid extent size.");
+  std::lock_guard<std::mutex> guard(latch_);
+  page_id_t first_page_id = first_free_hint_;
+  size_t run = 0;
+  for (page_id_t page_id = first_free_hint_; run < num_pages; ++page_id) {
+    if (static_cast<size_t>(page_id / PAGES_PER_GROUP) == groups_.size()) {
+      AddGroup();
+    }
+    // A run never spans a bitmap page.
+    if (page_id % PAGES_PER_GROUP == 0) {
+      run = 0;
+    }
+    if (IsTaken(page_id)) {
+      run = 0;
+      continue;
+    }
+    if (run == 0) {
+      first_page_id = page_id;
+    }
+    run++;
+  }
+  for (page_id_t page_id = first_page_id; page_id < first_page_id + static_cast<page_id_t>(num_pages); ++page_id) {
+    char &byte = reserved_[page_id / PAGES_PER_GROUP][page_id % PAGES_PER_GROUP / 8];
+    byte = static_cast<char>(byte | 1 << (page_id % 8));
+  }
+  if (first_page_id == first_free_hint_) {
+    first_free_hint_ = first_page_id + static_cast<page_id_t>(num_pages);
+  }
+  return first_page_id;
+}
+
+void PageAllocator::AllocateReserved(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto group = static_cast<size_t>(page_id / PAGES_PER_GROUP);
+  size_t byte = page_id % PAGES_PER_GROUP / 8;
+  int mask = 1 << (page_id % 8);
+  BUSTUB_ASSERT(group < groups_.size() && (reserved_[group][byte] & mask) != 0, "Page is not reserved.");
+  reserved_[group][byte] = static_cast<char>(reserved_[group][byte] & ~mask);
+  groups_[group][byte] = static_cast<char>(groups_[group][byte] | mask);
+  dirty_[group] = true;
+  num_allocated_++;
+}
+
+void PageAllocator::Deallocate(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto group = static_cast<size_t>(page_id / PAGES_PER_GROUP);
+  if (page_id < 0 || group >= groups_.size()) {
+    return;
+  }
+  char &byte = groups_[group][page_id % PAGES_PER_GROUP / 8];
+  int mask = 1 << (page_id % 8);
+  if ((byte & mask) == 0) {
+    return;
+  }
+  byte = static_cast<char>(byte & ~mask);
+  dirty_[group] = true;
+  num_allocated_--;
+  first_free_hint_ = std::min(first_free_hint_, page_id);
+}
+
+bool PageAllocator::IsAllocated(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto group = static_cast<size_t>(page_id / PAGES_PER_GROUP);
+  if (page_id < 0 || group >= groups_.size()) {
+    return false;
+  }
+  return (groups_[group][page_id % PAGES_PER_GROUP / 8] >> (page_id % 8) & 1) != 0;
+}
+
+size_t PageAllocator::GetNumAllocated() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return num_allocated_;
+}
+
+bool PageAllocator::IsTaken(page_id_t page_id) const {
+  auto group = static_cast<size_t>(page_id / PAGES_PER_GROUP);
+  size_t byte = page_id % PAGES_PER_GROUP / 8;
+  return ((groups_[group][byte] | reserved_[group][byte]) >> (page_id % 8) & 1) != 0;
+}
+
+void PageAllocator::AddGroup() {
+  groups_.emplace_back(PAGE_SIZE, 0);
+  reserved_.emplace_back(PAGE_SIZE, 0);
+  dirty_.push_back(false);
+}
+
+std::vector<std::pair<size_t, std::vector<char>>> PageAllocator::TakeDirtyGroups() {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<std::pair<size_t, std::vector<char>>> dirty_groups;
+  for (size_t group = 0; group < groups_.size(); ++group) {
+    if (dirty_[group]) {
+      dirty_groups.emplace_back(group, groups_[group]);
+      dirty_[group] = false;
+    }
+  }
+  return dirty_groups;
+}
+
+}  // namespace bustub
@@ -0,0 +1,251 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simulated_disk_manager.cpp
+//
+// Identification: src/storage/disk/simulated_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/simulated_disk_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>  // NOLINT
+#include <utility>
+
+namespace bustub {
+
+using std::chrono::microseconds;
+
+SimulatedDiskProfile SimulatedDiskProfile::Ssd() {
+  SimulatedDiskProfile profile;
+  profile.read_ = {microseconds(80), 0.3};
+  profile.write_ = {microseconds(20), 0.3};
+  profile.log_write_ = {microseconds(30), 0.3};
+  profile.sync_ = {microseconds(100), 0.5};
+  profile.bandwidth_ = static_cast<uint64_t>(2) << 30;
+  return profile;
+}
+
+SimulatedDiskProfile SimulatedDiskProfile::Hdd() {
+  SimulatedDiskProfile profile;
+  profile.read_ = {microseconds(5000), 0.5};
+  profile.write_ = {microseconds(5000), 0.5};
+  profile.log_write_ = {microseconds(2000), 0.3};
+  profile.sync_ = {microseconds(8000), 0.5};
+  profile.bandwidth_ = static_cast<uint64_t>(150) << 20;
+  return profile;
+}
+
+SimulatedDiskProfile SimulatedDiskProfile::NetworkStorage() {
+  SimulatedDiskProfile profile;
+  profile.read_ = {microseconds(500), 0.8};
+  profile.write_ = {microseconds(800), 0.8};
+  profile.log_write_ = {microseconds(800), 0.8};
+  profile.sync_ = {microseconds(1500), 0.8};
+  profile.bandwidth_ = static_cast<uint64_t>(250) << 20;
+  profile.stall_probability_ = 0.002;
+  profile.stall_ = microseconds(20000);
+  return profile;
+}
+
+SimulatedDiskManager::SimulatedDiskManager(DiskManager *disk_manager, const SimulatedDiskProfile &profile,
+                                           uint32_t seed)
+    : disk_manager_(disk_manager), profile_(profile), random_(seed) {
+  timer_thread_ = std::thread(&SimulatedDiskManager::RunCompletions, this);
+}
+
+SimulatedDiskManager::~SimulatedDiskManager() {
+  {
+    std::lock_guard<std::mutex> guard(completions_latch_);
+    stop_ = true;
+  }
+  completions_cv_.notify_all();
+  timer_thread_.join();
+}
+
+void SimulatedDiskManager::CompleteAt(std::chrono::steady_clock::time_point done, std::function<void()> completion) {
+  {
+    std::lock_guard<std::mutex> guard(completions_latch_);
+    completions_.emplace(done, std::move(completion));
+  }
+  completions_cv_.notify_all();
+}
+
+void SimulatedDiskManager::RunCompletions() {
+  std::unique_lock<std::mutex> lock(completions_latch_);
+  // requests still in flight when stopping are completed first
+  while (!stop_ || num_pending_ != 0) {
+    if (completions_.empty()) {
+      completions_cv_.wait(lock);
+      continue;
+    }
+    auto next = completions_.begin();
+    if (next->first > std::chrono::steady_clock::now()) {
+      completions_cv_.wait_until(lock, next->first);
+      continue;
+    }
+    std::function<void()> completion = std::move(next->second);
+    completions_.erase(next);
+    lock.unlock();
+    completion();
+    lock.lock();
+    num_pending_--;
+    completions_cv_.notify_all();
+  }
+}
+
+std::chrono::steady_clock::time_point SimulatedDiskManager::GetCompletionTime(const DiskLatency &latency,
+                                                                              size_t num_bytes) {
+  auto now = std::chrono::steady_clock::now();
+  std::chrono::nanoseconds delay{0};
+  bool stall = false;
+  {
+    std::lock_guard<std::mutex> guard(random_latch_);
+    if (latency.median_.count() > 0) {
+      double median_nanos = std::chrono::duration<double, std::nano>(latency.median_).count();
+      double nanos = median_nanos;
+      if (latency.sigma_ > 0) {
+        nanos = std::lognormal_distribution<double>(std::log(median_nanos), latency.sigma_)(random_);
+      }
+      delay = std::chrono::nanoseconds(static_cast<int64_t>(nanos));
+    }
+    if (profile_.stall_probability_ > 0) {
+      stall = std::uniform_real_distribution<double>(0, 1)(random_) < profile_.stall_probability_;
+    }
+  }
+  if (stall) {
+    delay += profile_.stall_;
+    num_stalls_++;
+  }
+  auto done = now + delay;
+  if (profile_.bandwidth_ != 0 && num_bytes != 0) {
+    // transfers go over the device one after the other, a transfer that has to wait completes later
+    auto transfer = std::chrono::nanoseconds(static_cast<int64_t>(1e9 * num_bytes / profile_.bandwidth_));
+    std::lock_guard<std::mutex> guard(bandwidth_latch_);
+    bandwidth_free_ = std::max(bandwidth_free_, now) + transfer;
+    done = std::max(done, bandwidth_free_);
+  }
+  return done;
+}
+
+void SimulatedDiskManager::ShutDown() { disk_manager_->ShutDown(); }
+
+void SimulatedDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.write_, PAGE_SIZE);
+  disk_manager_->WritePage(page_id, page_data);
+  std::this_thread::sleep_until(done);
+  data_file_io_.RecordWrite(PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+void SimulatedDiskManager::WritePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) {
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.write_, num_pages * PAGE_SIZE);
+  disk_manager_->WritePages(first_page_id, pages_data, num_pages);
+  std::this_thread::sleep_until(done);
+  data_file_io_.RecordWrite(num_pages * PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+void SimulatedDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.read_, PAGE_SIZE);
+  disk_manager_->ReadPage(page_id, page_data);
+  std::this_thread::sleep_until(done);
+  data_file_io_.RecordRead(PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+void SimulatedDiskManager::ReadPages(page_id_t first_page_id, char *const *pages_data, size_t num_pages) {
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.read_, num_pages * PAGE_SIZE);
+  disk_manager_->ReadPages(first_page_id, pages_data, num_pages);
+  std::this_thread::sleep_until(done);
+  data_file_io_.RecordRead(num_pages * PAGE_SIZE, std::chrono::steady_clock::now() - start);
+}
+
+void SimulatedDiskManager::WritePageAsync(page_id_t page_id, const char *page_data, io_callback_fn callback) {
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.write_, PAGE_SIZE);
+  {
+    std::lock_guard<std::mutex> guard(completions_latch_);
+    num_pending_++;
+  }
+  disk_manager_->WritePageAsync(page_id, page_data, [this, start, done, callback = std::move(callback)](bool success) {
+    CompleteAt(done, [this, start, success, callback] {
+      data_file_io_.RecordWrite(PAGE_SIZE, std::chrono::steady_clock::now() - start);
+      if (callback) {
+        callback(success);
+      }
+    });
+  });
+}
+
+void SimulatedDiskManager::ReadPageAsync(page_id_t page_id, char *page_data, io_callback_fn callback) {
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.read_, PAGE_SIZE);
+  {
+    std::lock_guard<std::mutex> guard(completions_latch_);
+    num_pending_++;
+  }
+  disk_manager_->ReadPageAsync(page_id, page_data, [this, start, done, callback = std::move(callback)](bool success) {
+    CompleteAt(done, [this, start, success, callback] {
+      data_file_io_.RecordRead(PAGE_SIZE, std::chrono::steady_clock::now() - start);
+      if (callback) {
+        callback(success);
+      }
+    });
+  });
+}
+
+void SimulatedDiskManager::WaitForAsyncIO() {
+  disk_manager_->WaitForAsyncIO();
+  std::unique_lock<std::mutex> lock(completions_latch_);
+  completions_cv_.wait(lock, [this] { return num_pending_ == 0; });
+}
+
+const char *SimulatedDiskManager::GetAsyncIOBackend() { return disk_manager_->GetAsyncIOBackend(); }
+
+void SimulatedDiskManager::Sync() {
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.sync_, 0);
+  disk_manager_->Sync();
+  std::this_thread::sleep_until(done);
+  data_file_io_.RecordSync(std::chrono::steady_clock::now() - start);
+}
+
+void SimulatedDiskManager::WriteLog(char *log_data, int size) {
+  if (size == 0) {
+    disk_manager_->WriteLog(log_data, size);
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.log_write_, size);
+  disk_manager_->WriteLog(log_data, size);
+  std::this_thread::sleep_until(done);
+  log_file_io_.RecordWrite(size, std::chrono::steady_clock::now() - start);
+}
+
+bool SimulatedDiskManager::ReadLog(char *log_data, int size, int offset) {
+  auto start = std::chrono::steady_clock::now();
+  auto done = GetCompletionTime(profile_.read_, size);
+  bool read = disk_manager_->ReadLog(log_data, size, offset);
+  std::this_thread::sleep_until(done);
+  log_file_io_.RecordRead(read ? size : 0, std::chrono::steady_clock::now() - start);
+  return read;
+}
+
+page_id_t SimulatedDiskManager::AllocatePage() { return disk_manager_->AllocatePage(); }
+
+void SimulatedDiskManager::DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+page_id_t SimulatedDiskManager::ReserveExtent(size_t num_pages) { return disk_manager_->ReserveExtent(num_pages); }
+
+void SimulatedDiskManager::AllocateReservedPage(page_id_t page_id) { disk_manager_->AllocateReservedPage(page_id); }
+
+bool SimulatedDiskManager::IsPageAllocated(page_id_t page_id) { return disk_manager_->IsPageAllocated(page_id); }
+
+}  // namespace bustub
@@ -38,8 +38,9 @@ bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key,
 	else{
 		array_[bucket_ind].first = key;
 		array_[bucket_ind].second = value;
-		occupied_[bucket_ind] = 1;
-		readable_[bucket_ind] = 1;
+		/*Both arrays are bitmaps with one bit per slot*/
+		occupied_[bucket_ind / 8] |= static_cast<char>(1 << (bucket_ind % 8));
+		readable_[bucket_ind / 8] |= static_cast<char>(1 << (bucket_ind % 8));
 		return true;
 	}
 }
@@ -47,13 +48,13 @@ bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key,
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
 	if(this->IsReadable(bucket_ind)){
-		readable_[bucket_ind] = 0;
+		readable_[bucket_ind / 8] &= static_cast<char>(~(1 << (bucket_ind % 8)));
 	}
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
-	if(occupied_[bucket_ind] == 1)
+	if((occupied_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0)
 		return true;
 	else
 		return false;
@@ -61,7 +62,7 @@ bool HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
-	if(readable_[bucket_ind] == 1)
+	if((readable_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0)
 		return true;
 	else
 		return false;
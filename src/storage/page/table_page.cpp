@@ -304,6 +304,54 @@ bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
   return true;
 }
 
+bool TablePage::GetTupleOptimistic(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager,
+                                   bool *result) {
+  uint64_t version;
+  if (!TryOptimisticRLatch(&version)) {
+    return false;
+  }
+  // Until the read is validated, every value may be torn, so it is checked against the page bounds before use.
+  uint32_t slot_num = rid.GetSlotNum();
+  bool exists = slot_num < GetTupleCount() && OFFSET_TUPLE_SIZE + SIZE_TUPLE * slot_num + sizeof(uint32_t) <= PAGE_SIZE;
+  uint32_t tuple_size = exists ? GetTupleSize(slot_num) : 0;
+  exists = exists && !IsDeleted(tuple_size);
+  if (!exists) {
+    if (!ValidateOptimisticRLatch(version)) {
+      return false;
+    }
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    *result = false;
+    return true;
+  }
+
+  // Acquiring a lock may block, which is left to the latched path.
+  if (enable_logging && !txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid)) {
+    return false;
+  }
+
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  if (static_cast<size_t>(tuple_offset) + tuple_size > PAGE_SIZE) {
+    return false;
+  }
+  auto *data = new char[tuple_size];
+  memcpy(data, GetData() + tuple_offset, tuple_size);
+  if (!ValidateOptimisticRLatch(version)) {
+    delete[] data;
+    return false;
+  }
+  tuple->size_ = tuple_size;
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->data_ = data;
+  tuple->rid_ = rid;
+  tuple->allocated_ = true;
+  *result = true;
+  return true;
+}
+
 bool TablePage::GetFirstTupleRid(RID *first_rid) {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
@@ -28,7 +28,7 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPageInExtent(&first_page_id_, &extent_));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
@@ -63,7 +63,7 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       cur_page->WLatch();
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPageInExtent(&next_page_id, &extent_));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -161,26 +161,34 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  // Read the tuple from the page.
-  page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  page->RUnlatch();
+  // Read the tuple from the page, taking the read latch only if a writer got in the way.
+  bool res;
+  if (!page->GetTupleOptimistic(rid, tuple, txn, lock_manager_, &res)) {
+    page->RLatch();
+    res = page->GetTuple(rid, tuple, txn, lock_manager_);
+    page->RUnlatch();
+  }
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   // Start an iterator from the first page.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(first_page_id_, strategy));
   page->RLatch();
   RID rid;
   // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
   page->GetFirstTupleRid(&rid);
+  page_id_t next_page_id = page->GetNextPageId();
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, false);
-  return TableIterator(this, rid, txn);
+  // Start loading the following pages while the caller works on the first one.
+  buffer_pool_manager_->ReadAhead(next_page_id, &TableHeap::NextPageId, strategy);
+  return TableIterator(this, rid, txn, strategy);
 }
 
+page_id_t TableHeap::NextPageId(Page *page) { return static_cast<TablePage *>(page)->GetNextPageId(); }
+
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
 }  // namespace bustub
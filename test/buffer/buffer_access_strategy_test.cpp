@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy_test.cpp
+//
+// Identification: test/buffer/buffer_access_strategy_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/**
+ * Interleaves a sequential scan over scan_page_ids with point lookups on hot_page_ids and returns the hit rate of the
+ * point lookups. The scan reads through the given strategy (nullptr = regular FetchPage).
+ */
+static double RunScanWithLookups(BufferPoolManager *bpm, DiskManager *disk_manager,
+                                 const std::vector<page_id_t> &hot_page_ids,
+                                 const std::vector<page_id_t> &scan_page_ids, BufferAccessStrategy *strategy) {
+  unsigned int seed = 15645;
+  size_t lookups = 0;
+  size_t lookup_misses = 0;
+  for (page_id_t scan_page_id : scan_page_ids) {
+    Page *page = bpm->FetchPageWithStrategy(scan_page_id, strategy);
+    EXPECT_NE(nullptr, page);
+    EXPECT_EQ(scan_page_id, page->GetPageId());
+    EXPECT_TRUE(bpm->UnpinPage(scan_page_id, false));
+
+    page_id_t hot_page_id = hot_page_ids[rand_r(&seed) % hot_page_ids.size()];
+    int reads_before = disk_manager->GetNumReads();
+    EXPECT_NE(nullptr, bpm->FetchPage(hot_page_id));
+    lookup_misses += disk_manager->GetNumReads() - reads_before;
+    lookups++;
+    EXPECT_TRUE(bpm->UnpinPage(hot_page_id, false));
+  }
+  return 1.0 - static_cast<double>(lookup_misses) / lookups;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferAccessStrategyTest, ScanLookupHitRateBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_hot_pages = 32;
+  const size_t num_scan_pages = 512;
+
+  double hit_rates[2];
+  for (int use_ring = 0; use_ring < 2; use_ring++) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    // Scenario: create the table pages and the hot pages, then warm up the hot pages with a round of lookups.
+    std::vector<page_id_t> scan_page_ids;
+    std::vector<page_id_t> hot_page_ids;
+    for (size_t i = 0; i < num_scan_pages + num_hot_pages; i++) {
+      page_id_t page_id;
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+      bpm->UnpinPage(page_id, true);
+      (i < num_scan_pages ? scan_page_ids : hot_page_ids).push_back(page_id);
+    }
+    for (page_id_t hot_page_id : hot_page_ids) {
+      ASSERT_NE(nullptr, bpm->FetchPage(hot_page_id));
+      bpm->UnpinPage(hot_page_id, false);
+    }
+
+    // Scenario: scan the table twice while point lookups keep hitting the hot pages.
+    BufferAccessStrategy strategy;
+    for (int round = 0; round < 2; round++) {
+      hit_rates[use_ring] =
+          RunScanWithLookups(bpm, disk_manager, hot_page_ids, scan_page_ids, use_ring == 1 ? &strategy : nullptr);
+    }
+
+    // Scenario: the data read through the ring is intact.
+    for (page_id_t page_id : scan_page_ids) {
+      Page *page = bpm->FetchPageWithStrategy(page_id, &strategy);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+      bpm->UnpinPage(page_id, false);
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+
+  std::cout << "[BENCHMARK] point lookup hit rate during scan: without ring=" << hit_rates[0]
+            << " with ring=" << hit_rates[1] << std::endl;
+  // The ring only ever occupies BUFFER_RING_SIZE frames, and the hot pages fit in the rest of the pool.
+  EXPECT_DOUBLE_EQ(1.0, hit_rates[1]);
+  EXPECT_GT(hit_rates[1], hit_rates[0]);
+}
+
+}  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_concurrent_test.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_concurrent_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerConcurrentTest, ShardedNewFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_shards = 4;
+  const int num_threads = 8;
+  const int pages_per_thread = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+  EXPECT_EQ(num_shards, bpm->GetNumShards());
+
+  // Scenario: every thread creates its own pages, stamps them with their page id and unpins them dirty. The pool is
+  // smaller than the total number of pages, so pages are evicted and written back while other threads are running.
+  std::vector<std::vector<page_id_t>> created(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, &created, tid]() {
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(&page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+        created[tid].push_back(page_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  // Scenario: all threads read back all pages concurrently and must see the content that was written.
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, &created]() {
+      for (const auto &page_ids : created) {
+        for (page_id_t page_id : page_ids) {
+          Page *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+          EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerConcurrentTest, HitPathScalingBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const int ops_per_thread = 5000;
+
+  // Scenario: all pages are resident, so every FetchPage is a hit. We measure fetch + unpin throughput for a single
+  // latch and for a sharded pool as the number of threads grows.
+  for (size_t num_shards : {static_cast<size_t>(1), static_cast<size_t>(16)}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, false);
+      page_ids.push_back(page_id);
+    }
+
+    for (int num_threads : {1, 2, 4, 8}) {
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([bpm, &page_ids, tid]() {
+          unsigned int seed = tid;
+          for (int i = 0; i < ops_per_thread; i++) {
+            page_id_t page_id = page_ids[rand_r(&seed) % page_ids.size()];
+            Page *page = bpm->FetchPage(page_id);
+            ASSERT_NE(nullptr, page);
+            bpm->UnpinPage(page_id, false);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "[BENCHMARK] shards=" << num_shards << " threads=" << num_threads
+                << " fetch+unpin/s=" << static_cast<size_t>(num_threads * ops_per_thread / elapsed.count())
+                << std::endl;
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
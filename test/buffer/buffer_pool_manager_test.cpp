@@ -12,9 +12,16 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"
+#include <chrono>  // NOLINT
+#include <climits>
 #include <cstdio>
+#include <iostream>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "gtest/gtest.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/simulated_disk_manager.h"
 
 namespace bustub {
 
@@ -141,4 +148,451 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, LRUKReplacerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 1, ReplacerType::LRU_K);
+  EXPECT_EQ(ReplacerType::LRU_K, bpm->GetReplacerType());
+
+  // Scenario: page 0 is used twice, with more accesses of another page in between than the correlated reference
+  // period, so it has a full access history.
+  page_id_t hot_page_id;
+  auto *hot_page = bpm->NewPage(&hot_page_id);
+  ASSERT_NE(nullptr, hot_page);
+  snprintf(hot_page->GetData(), PAGE_SIZE, "Hot");
+  EXPECT_EQ(true, bpm->UnpinPage(hot_page_id, true));
+  page_id_t other_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&other_page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(other_page_id, false));
+  for (size_t i = 0; i < LRUK_CORRELATED_PERIOD; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(other_page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(other_page_id, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(hot_page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(hot_page_id, false));
+
+  // Scenario: a scan touches many more pages than fit into the pool, each of them once.
+  for (size_t i = 0; i < buffer_pool_size * 3; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: the hot page was never evicted, so it is still resident and unchanged.
+  size_t num_writes = disk_manager->GetNumWrites();
+  hot_page = bpm->FetchPage(hot_page_id);
+  ASSERT_NE(nullptr, hot_page);
+  EXPECT_EQ(0, strcmp(hot_page->GetData(), "Hot"));
+  EXPECT_TRUE(hot_page->IsDirty());
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+  EXPECT_EQ(true, bpm->UnpinPage(hot_page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** Next page function for the read-ahead test: every page stores the id of its successor in its first bytes. */
+static page_id_t ChainedNextPageId(Page *page) { return *reinterpret_cast<page_id_t *>(page->GetData()); }
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReadAheadTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int chain_length = 8;
+
+  // Scenario: write a chain of pages to disk, each page pointing to the next one.
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (int i = 0; i < chain_length; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    *reinterpret_cast<page_id_t *>(page->GetData()) = i + 1 < chain_length ? page_id + 1 : INVALID_PAGE_ID;
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: a cold pool reads ahead along the chain through a buffer ring. Destroying the ring waits for the
+  // read-ahead to complete, after which the prefetched pages are resident.
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  bpm->SetReadAheadDepth(4);
+  EXPECT_EQ(4, bpm->GetReadAheadDepth());
+  int num_reads = disk_manager->GetNumReads();
+  {
+    BufferAccessStrategy strategy(4);
+    bpm->ReadAhead(1, ChainedNextPageId, &strategy);
+  }
+  EXPECT_EQ(num_reads + 4, disk_manager->GetNumReads());
+  EXPECT_EQ(4, bpm->GetMetrics().read_ahead_pages_);
+  EXPECT_EQ(0, bpm->GetMetrics().fetch_hits_ + bpm->GetMetrics().fetch_misses_);
+  for (page_id_t page_id = 1; page_id <= 4; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id + 1, ChainedNextPageId(page));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_reads + 4, disk_manager->GetNumReads());
+
+  // Scenario: with read-ahead disabled, nothing is loaded.
+  bpm->SetReadAheadDepth(0);
+  {
+    BufferAccessStrategy strategy(4);
+    bpm->ReadAhead(5, ChainedNextPageId, &strategy);
+  }
+  EXPECT_EQ(num_reads + 4, disk_manager->GetNumReads());
+
+  // Scenario: a scan that moves along the chain one page at a time reads every page ahead exactly once. The horizon is
+  // extended once the scan is half the depth away from it.
+  delete bpm;
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  bpm->SetReadAheadDepth(4);
+  num_reads = disk_manager->GetNumReads();
+  {
+    BufferAccessStrategy strategy(8);
+    std::vector<int> expected_reads{4, 4, 6, 6, 7, 7, 7};
+    for (page_id_t page_id = 1; page_id < chain_length; ++page_id) {
+      bpm->ReadAhead(page_id, ChainedNextPageId, &strategy);
+      int expected = num_reads + expected_reads[page_id - 1];
+      for (int i = 0; i < 1000 && disk_manager->GetNumReads() < expected; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      EXPECT_EQ(expected, disk_manager->GetNumReads());
+    }
+  }
+  EXPECT_EQ(chain_length - 1, bpm->GetMetrics().read_ahead_pages_);
+  EXPECT_EQ(0, bpm->GetMetrics().fetch_hits_ + bpm->GetMetrics().fetch_misses_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 2);
+
+  // Scenario: fill the pool with dirty unpinned pages.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the background writer cleans all evictable frames.
+  bpm->RunBackgroundWriter(1.0, std::chrono::milliseconds(1));
+  for (int i = 0; i < 1000 && bpm->GetBackgroundWriterStats().pages_written_ < buffer_pool_size; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bpm->StopBackgroundWriter();
+  auto stats = bpm->GetBackgroundWriterStats();
+  EXPECT_EQ(buffer_pool_size, stats.pages_written_);
+  EXPECT_EQ(0, stats.queue_depth_);
+
+  // Scenario: evicting the cleaned pages does not write anything in the foreground.
+  int num_writes = disk_manager->GetNumWrites();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+
+  // Scenario: the written pages are read back intact.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundWriterLatchTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t num_dirty = 4;
+
+  MemoryDiskManager memory;
+  SimulatedDiskProfile profile;
+  profile.write_ = {std::chrono::milliseconds(200), 0};
+  auto *disk_manager = new SimulatedDiskManager(&memory, profile);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 1);
+
+  for (size_t i = 0; i < num_dirty; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: while the background writer waits for its writes, the shard latch is free for other pages.
+  bpm->RunBackgroundWriter(1.0, std::chrono::milliseconds(1));
+  for (int i = 0; i < 1000 && bpm->GetBackgroundWriterStats().queue_depth_ == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  auto start = std::chrono::steady_clock::now();
+  page_id_t new_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+  EXPECT_EQ(true, bpm->UnpinPage(new_page_id, false));
+
+  // Scenario: a page that is being written is handed out once its write completed, with its content intact.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "Page 0"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: flushing all pages waits for the writes in flight, so every page is on disk afterwards.
+  bpm->FlushAllPages();
+  bpm->StopBackgroundWriter();
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_dirty); ++page_id) {
+    memory.ReadPage(page_id, data);
+    EXPECT_EQ(0, strcmp(data, ("Page " + std::to_string(page_id)).c_str()));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 20;
+  const int num_pages = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 4);
+
+  // Scenario: pages with consecutive ids spread over all shards are flushed with a single write.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  int num_writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + 1, disk_manager->GetNumWrites());
+
+  // Scenario: clean pages are skipped, and only adjacent dirty pages share a write.
+  for (page_id_t page_id : {2, 3, 7}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Dirty %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + 3, disk_manager->GetNumWrites());
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + 3, disk_manager->GetNumWrites());
+
+  // Scenario: a fresh pool reads back what was flushed.
+  delete bpm;
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    bool dirtied = page_id == 2 || page_id == 3 || page_id == 7;
+    EXPECT_EQ(std::string(dirtied ? "Dirty " : "Page ") + std::to_string(page_id), page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4096;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 8);
+  auto dirty_all = [&]() {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+  };
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: write every page on its own and sync once, as a page-at-a-time checkpoint does.
+  int num_writes = disk_manager->GetNumWrites();
+  int num_syncs = disk_manager->GetNumSyncs();
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    EXPECT_EQ(true, bpm->FlushPage(page_id));
+  }
+  disk_manager->Sync();
+  std::chrono::duration<double, std::milli> per_page = std::chrono::steady_clock::now() - start;
+  int per_page_writes = disk_manager->GetNumWrites() - num_writes;
+  EXPECT_EQ(static_cast<int>(buffer_pool_size), per_page_writes);
+  EXPECT_EQ(1, disk_manager->GetNumSyncs() - num_syncs);
+
+  // Scenario: the coalesced flush makes the same pages durable with a handful of vectored writes and the same sync.
+  dirty_all();
+  num_writes = disk_manager->GetNumWrites();
+  num_syncs = disk_manager->GetNumSyncs();
+  start = std::chrono::steady_clock::now();
+  bpm->FlushAllPages();
+  std::chrono::duration<double, std::milli> coalesced = std::chrono::steady_clock::now() - start;
+  int coalesced_writes = disk_manager->GetNumWrites() - num_writes;
+  EXPECT_GE(static_cast<int>(buffer_pool_size / IOV_MAX) + 1, coalesced_writes);
+  EXPECT_LT(coalesced_writes * 100, per_page_writes);
+  EXPECT_EQ(1, disk_manager->GetNumSyncs() - num_syncs);
+
+  std::cout << "[BENCHMARK] flush and sync " << buffer_pool_size << " pages: per page " << per_page_writes
+            << " writes in " << per_page.count() << " ms, coalesced " << coalesced_writes << " writes in "
+            << coalesced.count() << " ms" << std::endl;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_shards = 2;
+  const size_t grown_pool_size = buffer_pool_size + BUFFER_POOL_CHUNK_SIZE * num_shards;
+  const size_t max_pool_size = buffer_pool_size + 2 * BUFFER_POOL_CHUNK_SIZE * num_shards;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm =
+      new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards, ReplacerType::CLOCK, max_pool_size);
+
+  // Scenario: growing adds a chunk to every shard, and all new frames can hold pinned pages.
+  EXPECT_EQ(grown_pool_size, bpm->Resize(grown_pool_size));
+  EXPECT_EQ(grown_pool_size, bpm->GetPoolSize());
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < grown_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    page_ids.push_back(page_id);
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: chunks with pinned pages are not released.
+  EXPECT_EQ(grown_pool_size, bpm->Resize(buffer_pool_size));
+
+  // Scenario: once unpinned, the pages of the released chunks are written back and can be fetched again.
+  for (page_id_t page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->Resize(buffer_pool_size));
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Page " + std::to_string(page_id), page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the pool never grows past its maximum size, and released chunks can be reused.
+  EXPECT_EQ(max_pool_size, bpm->Resize(max_pool_size * 2));
+  for (page_id_t page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  for (page_id_t page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, WarmRestartTest) {
+  const std::string db_name = "test.db";
+  const std::string snapshot_file = "test.warm";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 20;
+  const int num_hot_pages = 5;
+  remove(snapshot_file.c_str());
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 2);
+  EXPECT_EQ(0, bpm->EnableWarmRestart(snapshot_file));
+
+  // Scenario: the last pages of a table are hot.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (page_id_t page_id = num_pages - num_hot_pages; page_id < num_pages; ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: a smaller pool preloads only the hot pages, with a single read, and serves them as hits.
+  int num_reads = disk_manager->GetNumReads();
+  bpm = new BufferPoolManager(num_hot_pages, disk_manager);
+  EXPECT_EQ(num_hot_pages, bpm->EnableWarmRestart(snapshot_file));
+  EXPECT_EQ(num_reads + 1, disk_manager->GetNumReads());
+  for (page_id_t page_id = num_pages - num_hot_pages; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Page " + std::to_string(page_id), page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_hot_pages, bpm->GetMetrics().fetch_hits_);
+  EXPECT_EQ(0, bpm->GetMetrics().fetch_misses_);
+  EXPECT_EQ(num_reads + 1, disk_manager->GetNumReads());
+
+  // The pool saves its snapshot when it is destroyed.
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove(snapshot_file.c_str());
+
+  delete disk_manager;
+}
+
 }  // namespace bustub
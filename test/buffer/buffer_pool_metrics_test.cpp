@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_metrics_test.cpp
+//
+// Identification: test/buffer/buffer_pool_metrics_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolMetricsTest, LatencyHistogramTest) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.GetSnapshot().GetPercentile(50));
+
+  // Scenario: 90 fast and 10 slow operations.
+  for (int i = 0; i < 90; i++) {
+    histogram.Record(std::chrono::nanoseconds(100));
+  }
+  for (int i = 0; i < 10; i++) {
+    histogram.Record(std::chrono::microseconds(100));
+  }
+  LatencyHistogramSnapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(100, snapshot.count_);
+  EXPECT_DOUBLE_EQ((90 * 100 + 10 * 100000) / 100.0, snapshot.GetMean());
+  // Percentiles are reported as the end of their bucket, which is 1/16 of a power of two wide.
+  EXPECT_EQ(104, snapshot.GetPercentile(50));
+  EXPECT_EQ(104, snapshot.GetPercentile(90));
+  EXPECT_EQ(102400, snapshot.GetPercentile(99));
+
+  // Scenario: snapshots add up.
+  snapshot.Merge(histogram.GetSnapshot());
+  EXPECT_EQ(200, snapshot.count_);
+  EXPECT_EQ(102400, snapshot.GetPercentile(99));
+
+  // Scenario: small latencies are exact, and every bucket stays within 1/16 of its latencies.
+  LatencyHistogram spread;
+  for (uint64_t nanos = 1; nanos < (static_cast<uint64_t>(1) << 30); nanos = nanos * 5 / 4 + 1) {
+    spread.Record(std::chrono::nanoseconds(nanos));
+    uint64_t percentile = spread.GetSnapshot().GetPercentile(100);
+    EXPECT_LT(nanos, percentile);
+    EXPECT_LE(percentile, nanos + std::max<uint64_t>(1, nanos / 16));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolMetricsTest, BufferPoolManagerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 2);
+
+  // Scenario: fill the pool with dirty pages, then one more page evicts a dirty victim.
+  for (size_t i = 0; i <= buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  BufferPoolMetrics metrics = bpm->GetMetrics();
+  EXPECT_EQ(buffer_pool_size + 1, metrics.new_pages_);
+  EXPECT_EQ(1, metrics.evictions_);
+  EXPECT_EQ(1, metrics.dirty_writebacks_);
+  EXPECT_EQ(1, metrics.write_latency_.count_);
+
+  // Scenario: page 4 is resident, page 0 was evicted and is read back.
+  ASSERT_NE(nullptr, bpm->FetchPage(4));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  metrics = bpm->GetMetrics();
+  EXPECT_EQ(1, metrics.fetch_hits_);
+  EXPECT_EQ(1, metrics.fetch_misses_);
+  EXPECT_DOUBLE_EQ(0.5, metrics.GetHitRatio());
+  EXPECT_EQ(1, metrics.read_latency_.count_);
+
+  // Scenario: pages 4 and 0 pin both frames of their shard, so page 2 of the same shard cannot be loaded.
+  EXPECT_EQ(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(1, bpm->GetMetrics().failed_allocations_);
+  EXPECT_EQ(1, bpm->GetShardMetrics(0).failed_allocations_);
+  EXPECT_EQ(0, bpm->GetShardMetrics(1).failed_allocations_);
+
+  // Scenario: the text dump lists every counter.
+  std::string dump = bpm->GetMetrics().ToString();
+  EXPECT_NE(std::string::npos, dump.find("fetch_hits 1\n"));
+  EXPECT_NE(std::string::npos, dump.find("failed_allocations 1\n"));
+  EXPECT_NE(std::string::npos, dump.find("read_p99_ns "));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
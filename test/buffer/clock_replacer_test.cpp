@@ -59,4 +59,44 @@ TEST(ClockReplacerTest, SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, ConcurrentPinVictimTest) {
+  const size_t num_frames = 64;
+  ClockReplacer clock_replacer(num_frames);
+  for (size_t i = 0; i < num_frames; i++) {
+    clock_replacer.Unpin(i);
+  }
+
+  // Scenario: one thread pins the even frames without any latch while another victimizes frames. Every frame must
+  // leave the replacer exactly once, either as a victim or because it was pinned.
+  std::vector<int> victims;
+  std::thread pinner([&clock_replacer]() {
+    for (size_t i = 0; i < num_frames; i += 2) {
+      clock_replacer.Pin(i);
+    }
+  });
+  std::thread evicter([&clock_replacer, &victims]() {
+    int value;
+    while (clock_replacer.Victim(&value)) {
+      victims.push_back(value);
+    }
+  });
+  pinner.join();
+  evicter.join();
+
+  int value;
+  while (clock_replacer.Victim(&value)) {
+    victims.push_back(value);
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+  std::vector<bool> seen(num_frames, false);
+  for (int victim : victims) {
+    EXPECT_FALSE(seen[victim]) << "frame " << victim << " victimized twice";
+    seen[victim] = true;
+  }
+  for (size_t i = 1; i < num_frames; i += 2) {
+    EXPECT_TRUE(seen[i]) << "unpinned frame " << i << " was lost";
+  }
+}
+
 }  // namespace bustub
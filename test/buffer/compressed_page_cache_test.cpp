@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/compressed_page_cache.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, SampleTest) {
+  CompressedPageCache cache(1024);
+  std::vector<char> page(PAGE_SIZE);
+  std::vector<char> result(PAGE_SIZE);
+
+  // Scenario: a compressible page goes in and comes out once.
+  snprintf(page.data(), PAGE_SIZE, "Hello");
+  EXPECT_TRUE(cache.Insert(0, page.data()));
+  EXPECT_TRUE(cache.Lookup(0, result.data()));
+  EXPECT_EQ(0, memcmp(page.data(), result.data(), PAGE_SIZE));
+  EXPECT_FALSE(cache.Lookup(0, result.data()));
+
+  // Scenario: pages that do not compress are rejected.
+  std::mt19937 generator(15445);
+  std::vector<char> random_page(PAGE_SIZE);
+  for (auto &byte : random_page) {
+    byte = static_cast<char>(generator());
+  }
+  EXPECT_FALSE(cache.Insert(1, random_page.data()));
+
+  // Scenario: when the cache is full, the oldest pages are dropped.
+  for (page_id_t page_id = 0; page_id < 100; ++page_id) {
+    snprintf(page.data(), PAGE_SIZE, "Page %d", page_id);
+    EXPECT_TRUE(cache.Insert(page_id, page.data()));
+  }
+  CompressedPageCacheStats stats = cache.GetStats();
+  EXPECT_GE(1024, stats.compressed_bytes_);
+  EXPECT_EQ(101, stats.insertions_);
+  EXPECT_EQ(stats.insertions_ - 1, stats.num_pages_ + stats.evictions_);
+  EXPECT_LT(100, stats.GetCompressionRatio());
+  EXPECT_FALSE(cache.Lookup(0, result.data()));
+  EXPECT_TRUE(cache.Lookup(99, result.data()));
+  EXPECT_EQ("Page 99", std::string(result.data()));
+
+  // Scenario: erased pages are gone.
+  cache.Erase(98);
+  EXPECT_FALSE(cache.Lookup(98, result.data()));
+  stats = cache.GetStats();
+  EXPECT_EQ(2, stats.hits_);
+  EXPECT_EQ(3, stats.misses_);
+  EXPECT_EQ(1, stats.rejections_);
+
+  // Scenario: a reserved page is only added if nobody looked it up, erased or reserved it again in the meantime.
+  snprintf(page.data(), PAGE_SIZE, "Reserved");
+  uint64_t reservation = cache.Reserve(200);
+  EXPECT_TRUE(cache.Insert(200, page.data(), reservation));
+  EXPECT_FALSE(cache.Insert(200, page.data(), reservation));
+  reservation = cache.Reserve(200);
+  EXPECT_FALSE(cache.Lookup(200, result.data()));
+  EXPECT_FALSE(cache.Insert(200, page.data(), reservation));
+  reservation = cache.Reserve(201);
+  EXPECT_TRUE(cache.Insert(201, page.data(), cache.Reserve(201)));
+  EXPECT_FALSE(cache.Insert(201, page.data(), reservation));
+  EXPECT_TRUE(cache.Lookup(201, result.data()));
+  EXPECT_EQ("Reserved", std::string(result.data()));
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, BufferPoolManagerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const int num_pages = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  bpm->EnableCompressedCache(static_cast<size_t>(PAGE_SIZE) * num_pages);
+
+  // Scenario: evicted pages move to the compressed tier.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(num_pages - buffer_pool_size, bpm->GetCompressedCacheStats().num_pages_);
+
+  // Scenario: fetching them back does not read from disk.
+  int num_reads = disk_manager->GetNumReads();
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Page " + std::to_string(page_id), page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+  EXPECT_EQ(num_pages, bpm->GetCompressedCacheStats().hits_);
+
+  // Scenario: a deleted page is dropped from the compressed tier as well.
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  EXPECT_EQ(num_pages - buffer_pool_size - 1, bpm->GetCompressedCacheStats().num_pages_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 1024;
+  FrameArena arena(num_frames, true);
+  EXPECT_EQ(num_frames, arena.GetNumFrames());
+
+  // Scenario: frames are aligned for direct I/O, zeroed and back to back.
+  for (size_t frame = 0; frame < num_frames; ++frame) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrameData(frame)) % PAGE_SIZE);
+  }
+  EXPECT_EQ(arena.GetFrameData(0) + PAGE_SIZE, arena.GetFrameData(1));
+  EXPECT_EQ(0, arena.GetFrameData(num_frames - 1)[PAGE_SIZE - 1]);
+
+  // Scenario: an arena that spans huge pages starts at a huge page boundary.
+  if (arena.UsesHugePages()) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrameData(0)) % FrameArena::HUGE_PAGE_SIZE);
+  }
+  FrameArena small_arena(4, true);
+  EXPECT_FALSE(small_arena.UsesHugePages());
+
+  // Scenario: released frames read as zeroes and can be used again.
+  snprintf(arena.GetFrameData(1), PAGE_SIZE, "Hello");
+  snprintf(arena.GetFrameData(2), PAGE_SIZE, "World");
+  arena.Release(2, 1);
+  EXPECT_EQ("Hello", std::string(arena.GetFrameData(1)));
+  EXPECT_EQ("", std::string(arena.GetFrameData(2)));
+  snprintf(arena.GetFrameData(2), PAGE_SIZE, "Again");
+  EXPECT_EQ("Again", std::string(arena.GetFrameData(2)));
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolManagerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 2, ReplacerType::CLOCK,
+                                    buffer_pool_size + 2 * BUFFER_POOL_CHUNK_SIZE);
+  bpm->Resize(buffer_pool_size + 2 * BUFFER_POOL_CHUNK_SIZE);
+
+  // Scenario: the data of every frame, grown ones included, is aligned for direct I/O and apart from the pages.
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+    EXPECT_NE(reinterpret_cast<char *>(page), page->GetData());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,231 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "concurrency/transaction_manager.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_replacer(7, 2, 0);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Frame 1 is unpinned twice but only counted once.
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(2);
+  lru_replacer.Unpin(3);
+  lru_replacer.Unpin(4);
+  lru_replacer.Unpin(5);
+  lru_replacer.Unpin(6);
+  lru_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_replacer.Size());
+
+  // Scenario: use frames 1 and 2 a second time. They now have two accesses and are protected.
+  lru_replacer.Pin(1);
+  lru_replacer.Unpin(1);
+  lru_replacer.Pin(2);
+  lru_replacer.Unpin(2);
+  EXPECT_EQ(6, lru_replacer.Size());
+
+  // Scenario: frames with a single access go first, in LRU order.
+  int value;
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: pinned frames are not victimized, pinning a victimized frame has no effect.
+  lru_replacer.Pin(5);
+  lru_replacer.Pin(3);
+  EXPECT_EQ(3, lru_replacer.Size());
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+
+  // Scenario: among frames with k accesses, the one with the oldest k-th most recent access goes first. Frame 5 was
+  // used last, but its second to last access is more recent than the one of frame 2.
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  lru_replacer.Unpin(5);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_replacer(4, 2, 2);
+
+  // Scenario: frame 2 is used again after one access of another frame, which continues its first use. Frame 0 is used
+  // again after three accesses of other frames, which counts as a second access.
+  lru_replacer.Unpin(0);
+  lru_replacer.Unpin(2);
+  lru_replacer.Unpin(3);
+  lru_replacer.Pin(2);
+  lru_replacer.Unpin(2);
+  lru_replacer.Pin(0);
+  lru_replacer.Unpin(0);
+
+  // Scenario: frame 1 is used many times in one burst like the current page of a scan, which is a single access.
+  for (int i = 0; i < 100; i++) {
+    lru_replacer.Pin(1);
+    lru_replacer.Unpin(1);
+  }
+
+  // Scenario: only frame 0 has two accesses, the others go first in LRU order.
+  int value;
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: the history of a victim is gone, its next use counts again.
+  lru_replacer.Unpin(1);
+  EXPECT_EQ(1, lru_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, RemoveTest) {
+  LRUKReplacer lru_replacer(3, 2, 0);
+
+  // Scenario: frames 1 and 0 are used twice each, frame 2 once.
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(0);
+  lru_replacer.Pin(1);
+  lru_replacer.Unpin(1);
+  lru_replacer.Pin(0);
+  lru_replacer.Unpin(0);
+  lru_replacer.Unpin(2);
+  EXPECT_EQ(3, lru_replacer.Size());
+
+  // Scenario: frame 0 gets a new page. The accesses of its old page are forgotten, so after one use of the new page it
+  // is evicted before frame 1, right after frame 2 which was used before it.
+  lru_replacer.Remove(0);
+  EXPECT_EQ(2, lru_replacer.Size());
+  lru_replacer.Unpin(0);
+  int value;
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: a removed frame is not victimized, removing a frame that is not in the replacer has no effect.
+  lru_replacer.Unpin(2);
+  lru_replacer.Remove(2);
+  lru_replacer.Remove(1);
+  EXPECT_FALSE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanAndIndexBenchmark) {
+  const size_t pool_size = 48;
+  const int num_block_pages = 40;
+  const int num_keys = 10000;
+  const int num_tuples = 20000;
+  const int num_scans = 2;
+  const size_t block_array_size = 4 * PAGE_SIZE / (4 * sizeof(std::pair<int, int>) + 1);
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 32};
+  Schema schema{std::vector<Column>{col1, col2}};
+  MemoryDiskManager disk_manager;
+  auto *lock_manager = new LockManager(TwoPLMode::STRICT, DeadlockMode::PREVENTION);
+  auto *txn_manager = new TransactionManager(lock_manager, nullptr);
+
+  // Scenario: a table several times larger than the buffer pool, built through a pool that holds all of it.
+  auto *build_bpm = new BufferPoolManager(1024, &disk_manager);
+  Transaction *txn = txn_manager->Begin();
+  auto *build_table = new TableHeap(build_bpm, lock_manager, nullptr, txn);
+  page_id_t first_page_id = build_table->GetFirstPageId();
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue("tuple " + std::to_string(i))},
+                &schema);
+    RID rid;
+    ASSERT_TRUE(build_table->InsertTuple(tuple, &rid, txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  delete build_table;
+  build_bpm->FlushAllPages();
+  delete build_bpm;
+
+  // Scenario: full scans through a TableIterator, with a hash index lookup every fourth tuple. The block pages of the
+  // index fit in the pool next to a few scan pages; the scan pins and unpins its current page for every tuple.
+  std::vector<std::pair<std::string, ReplacerType>> replacers{{"clock", ReplacerType::CLOCK},
+                                                               {"lru-2", ReplacerType::LRU_K}};
+  uint64_t lookup_misses[2];
+  for (size_t r = 0; r < replacers.size(); ++r) {
+    auto *bpm = new BufferPoolManager(pool_size, &disk_manager, nullptr, 1, replacers[r].second);
+    bpm->SetReadAheadDepth(0);
+    LinearProbeHashTable<int, int, IntComparator> index("index", bpm, IntComparator(),
+                                                        num_block_pages * block_array_size, HashFunction<int>());
+    for (int key = 0; key < num_keys; ++key) {
+      index.Insert(nullptr, key, key);
+    }
+    TableHeap table(bpm, lock_manager, nullptr, first_page_id);
+
+    unsigned int seed = 15445;
+    size_t num_lookups = 0;
+    lookup_misses[r] = 0;
+    txn = txn_manager->Begin();
+    for (int scan = 0; scan < num_scans; ++scan) {
+      int num_scanned = 0;
+      for (auto it = table.Begin(txn); it != table.End(); ++it) {
+        if (num_scanned++ % 4 != 0) {
+          continue;
+        }
+        uint64_t reads = disk_manager.GetNumReads();
+        std::vector<int> values;
+        int key = rand_r(&seed) % num_keys;
+        EXPECT_TRUE(index.GetValue(nullptr, key, &values));
+        lookup_misses[r] += disk_manager.GetNumReads() - reads;
+        num_lookups++;
+      }
+      EXPECT_EQ(num_tuples, num_scanned);
+    }
+    txn_manager->Commit(txn);
+    delete txn;
+    std::cout << "[BENCHMARK] " << replacers[r].first << ": " << lookup_misses[r] << " index page reads for "
+              << num_lookups << " lookups, buffer pool hit ratio " << bpm->GetMetrics().GetHitRatio() << std::endl;
+    delete bpm;
+  }
+
+  // Scan pages collect one access per pass however often they are pinned, so LRU-K keeps the index block pages.
+  EXPECT_LT(lookup_misses[1] * 10, lookup_misses[0]);
+
+  delete txn_manager;
+  delete lock_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  const size_t num_frames = 16;
+  PageTable page_table(num_frames);
+  frame_id_t frame_id;
+
+  // Scenario: a full table of strided page ids, as a shard of a sharded buffer pool sees them.
+  for (size_t i = 0; i < num_frames; i++) {
+    page_table.Insert(static_cast<page_id_t>(i * 4), static_cast<frame_id_t>(i));
+  }
+  for (size_t i = 0; i < num_frames; i++) {
+    ASSERT_TRUE(page_table.Find(static_cast<page_id_t>(i * 4), &frame_id));
+    EXPECT_EQ(static_cast<frame_id_t>(i), frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+
+  // Scenario: erasing every other page keeps the rest reachable, even where their probe sequences ran through the
+  // erased entries.
+  for (size_t i = 0; i < num_frames; i += 2) {
+    EXPECT_TRUE(page_table.Erase(static_cast<page_id_t>(i * 4)));
+  }
+  EXPECT_FALSE(page_table.Erase(0));
+  for (size_t i = 0; i < num_frames; i++) {
+    bool found = page_table.Find(static_cast<page_id_t>(i * 4), &frame_id);
+    EXPECT_EQ(i % 2 == 1, found);
+    if (found) {
+      EXPECT_EQ(static_cast<frame_id_t>(i), frame_id);
+    }
+  }
+
+  // Scenario: inserting an existing page moves it to the new frame.
+  page_table.Insert(4, 7);
+  ASSERT_TRUE(page_table.Find(4, &frame_id));
+  EXPECT_EQ(7, frame_id);
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentFindTest) {
+  const size_t num_frames = 64;
+  const int num_readers = 4;
+  const int num_rounds = 2000;
+  PageTable page_table(num_frames);
+
+  // Scenario: half of the frames keep their pages, the other half keeps changing pages under a single writer.
+  for (size_t i = 0; i < num_frames / 2; i++) {
+    page_table.Insert(static_cast<page_id_t>(i), static_cast<frame_id_t>(i));
+  }
+  std::atomic<bool> done{false};
+  std::thread writer([&]() {
+    for (int round = 0; round < num_rounds; round++) {
+      for (size_t i = num_frames / 2; i < num_frames; i++) {
+        auto page_id = static_cast<page_id_t>(round * num_frames + i);
+        page_table.Insert(page_id, static_cast<frame_id_t>(i));
+        page_table.Erase(page_id);
+      }
+    }
+    done = true;
+  });
+
+  // Scenario: lock-free lookups never return a wrong frame. They may miss an entry that is being moved, which is why
+  // the buffer pool repeats a failed lookup under the shard latch.
+  std::vector<std::thread> readers;
+  std::atomic<int> hits{0};
+  for (int r = 0; r < num_readers; r++) {
+    readers.emplace_back([&]() {
+      do {
+        for (size_t i = 0; i < num_frames / 2; i++) {
+          frame_id_t frame_id;
+          if (page_table.Find(static_cast<page_id_t>(i), &frame_id)) {
+            ASSERT_EQ(static_cast<frame_id_t>(i), frame_id);
+            hits++;
+          }
+        }
+      } while (!done);
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_LT(0, hits);
+}
+
+}  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util_test.cpp
+//
+// Identification: test/common/compression_util_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/compression_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(CompressionUtilTest, RoundTripTest) {
+  std::vector<char> page(PAGE_SIZE);
+  std::vector<char> compressed(CompressionUtil::MaxCompressedSize(PAGE_SIZE));
+  std::vector<char> decompressed(PAGE_SIZE);
+  auto round_trip = [&]() {
+    size_t size = CompressionUtil::Compress(page.data(), page.size(), compressed.data(), compressed.size());
+    EXPECT_LT(0, size);
+    EXPECT_EQ(PAGE_SIZE, CompressionUtil::Decompress(compressed.data(), size, decompressed.data(), PAGE_SIZE));
+    EXPECT_EQ(0, memcmp(page.data(), decompressed.data(), PAGE_SIZE));
+    return size;
+  };
+
+  // Scenario: an empty page shrinks to a handful of bytes, about one per 255 bytes of input.
+  EXPECT_GT(PAGE_SIZE / 128, round_trip());
+
+  // Scenario: a page of tuples with repeating text.
+  for (int i = 0; i < PAGE_SIZE / 32; ++i) {
+    snprintf(page.data() + i * 32, 32, "tuple %05d name bustub", i);
+  }
+  EXPECT_GT(PAGE_SIZE / 2, round_trip());
+
+  // Scenario: random data does not compress, but still fits into the worst case size.
+  std::mt19937 generator(15445);
+  for (auto &byte : page) {
+    byte = static_cast<char>(generator());
+  }
+  EXPECT_GE(CompressionUtil::MaxCompressedSize(PAGE_SIZE), round_trip());
+
+  // Scenario: output that does not fit into the buffer is reported as 0.
+  EXPECT_EQ(0, CompressionUtil::Compress(page.data(), page.size(), compressed.data(), PAGE_SIZE / 2));
+}
+
+// NOLINTNEXTLINE
+TEST(CompressionUtilTest, MalformedInputTest) {
+  std::vector<char> page(PAGE_SIZE, 'a');
+  std::vector<char> compressed(CompressionUtil::MaxCompressedSize(PAGE_SIZE));
+  std::vector<char> decompressed(PAGE_SIZE);
+  size_t size = CompressionUtil::Compress(page.data(), page.size(), compressed.data(), compressed.size());
+  ASSERT_LT(0, size);
+
+  // Scenario: truncated data and a too small output buffer are detected.
+  EXPECT_EQ(0, CompressionUtil::Decompress(compressed.data(), size - 2, decompressed.data(), PAGE_SIZE));
+  EXPECT_EQ(0, CompressionUtil::Decompress(compressed.data(), size, decompressed.data(), PAGE_SIZE - 1));
+
+  // Scenario: a match that points before the start of the output is detected.
+  const char bad_offset[] = {0x10, 'a', 0x02, 0x00};
+  EXPECT_EQ(0, CompressionUtil::Decompress(bad_offset, sizeof(bad_offset), decompressed.data(), PAGE_SIZE));
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -104,4 +105,53 @@ TEST(HashTableTest, SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertRemoveTest) {
+  const int num_threads = 4;
+  const int num_keys = 500;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  // Scenario: threads insert the same pairs at the same time, each pair goes in once.
+  std::atomic<int> inserted{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_keys; i++) {
+        inserted += ht.Insert(nullptr, i, i) ? 1 : 0;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_keys, inserted);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+  }
+
+  // Scenario: threads remove the same pairs at the same time, each pair goes away once.
+  std::atomic<int> removed{0};
+  threads.clear();
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_keys; i++) {
+        removed += ht.Remove(nullptr, i, i) ? 1 : 0;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_keys, removed);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/simulated_disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LogManagerTest, SampleTest) {
+  remove("test.db");
+  remove("test.log");
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManager(10, disk_manager, log_manager);
+  auto *lock_manager = new LockManager(TwoPLMode::STRICT, DeadlockMode::PREVENTION);
+  auto *txn_manager = new TransactionManager(lock_manager, log_manager);
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  Tuple tuple({ValueFactory::GetIntegerValue(15445)}, &schema);
+
+  log_manager->RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+
+  // Scenario: a transaction is persistent in the log once it committed, and the log file syncs on each write.
+  Transaction *txn = txn_manager->Begin();
+  auto *table = new TableHeap(bpm, lock_manager, log_manager, txn);
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, txn));
+  txn_manager->Commit(txn);
+  lsn_t commit_lsn = txn->GetPrevLSN();
+  EXPECT_EQ(3, commit_lsn);
+  EXPECT_LE(commit_lsn, log_manager->GetPersistentLSN());
+  EXPECT_EQ(disk_manager->GetNumFlushes(), disk_manager->GetMetrics().log_.syncs_);
+  delete txn;
+
+  // Scenario: a page is not written before its log records.
+  txn = txn_manager->Begin();
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, txn));
+  lsn_t insert_lsn = txn->GetPrevLSN();
+  EXPECT_LT(log_manager->GetPersistentLSN(), insert_lsn);
+  bpm->FlushPage(table->GetFirstPageId());
+  EXPECT_LE(insert_lsn, log_manager->GetPersistentLSN());
+
+  // Scenario: stopping the flush thread flushes the log records still in the log buffer.
+  txn_manager->Abort(txn);
+  lsn_t abort_lsn = txn->GetPrevLSN();
+  log_manager->StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+  EXPECT_EQ(abort_lsn, log_manager->GetPersistentLSN());
+  delete txn;
+
+  // Scenario: the records read back from the log in order, each linked to the previous record of its transaction.
+  std::vector<LogRecordType> types{LogRecordType::BEGIN,  LogRecordType::NEWPAGE, LogRecordType::INSERT,
+                                   LogRecordType::COMMIT, LogRecordType::BEGIN,   LogRecordType::INSERT,
+                                   LogRecordType::APPLYDELETE, LogRecordType::ABORT};
+  std::vector<char> log(LOG_BUFFER_SIZE);
+  ASSERT_TRUE(disk_manager->ReadLog(log.data(), LOG_BUFFER_SIZE, 0));
+  int offset = 0;
+  lsn_t prev_lsn = INVALID_LSN;
+  for (size_t i = 0; i < types.size(); ++i) {
+    int32_t header[5];
+    memcpy(header, log.data() + offset, sizeof(header));
+    EXPECT_EQ(static_cast<lsn_t>(i), header[1]);
+    EXPECT_EQ(types[i], static_cast<LogRecordType>(header[4]));
+    if (types[i] == LogRecordType::BEGIN) {
+      prev_lsn = INVALID_LSN;
+    }
+    EXPECT_EQ(prev_lsn, header[3]);
+    prev_lsn = header[1];
+    offset += header[0];
+  }
+  int32_t end;
+  memcpy(&end, log.data() + offset, sizeof(end));
+  EXPECT_EQ(0, end);
+
+  delete table;
+  delete txn_manager;
+  delete lock_manager;
+  delete bpm;
+  delete log_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LogManagerTest, GroupCommitTest) {
+  const int num_commits = 200;
+
+  // Scenario: with one committer every commit waits for a log write of its own, with more committers the commits that
+  // arrive during a log write share the next one, so they need far fewer log writes. Throughput is only printed, it
+  // depends on the machine.
+  double commits_per_second[2];
+  int num_flushes[2];
+  int num_threads[2] = {1, 8};
+  for (int round = 0; round < 2; ++round) {
+    MemoryDiskManager memory;
+    SimulatedDiskProfile profile;
+    profile.log_write_ = {std::chrono::milliseconds(2), 0};
+    auto *disk_manager = new SimulatedDiskManager(&memory, profile);
+    auto *log_manager = new LogManager(disk_manager);
+    auto *lock_manager = new LockManager(TwoPLMode::STRICT, DeadlockMode::PREVENTION);
+    auto *txn_manager = new TransactionManager(lock_manager, log_manager);
+    log_manager->RunFlushThread();
+
+    std::vector<Transaction *> txns;
+    for (int i = 0; i < num_commits; ++i) {
+      txns.push_back(txn_manager->Begin());
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads[round]; ++tid) {
+      threads.emplace_back([&, tid] {
+        for (int i = tid; i < num_commits; i += num_threads[round]) {
+          txn_manager->Commit(txns[i]);
+          EXPECT_LE(txns[i]->GetPrevLSN(), log_manager->GetPersistentLSN());
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    commits_per_second[round] = num_commits / elapsed.count();
+    num_flushes[round] = disk_manager->GetNumFlushes();
+    printf("[BENCHMARK] %d committers: %.0f commits/s, %d log writes for %d commits\n", num_threads[round],
+           commits_per_second[round], disk_manager->GetNumFlushes(), num_commits);
+
+    log_manager->StopFlushThread();
+    for (Transaction *txn : txns) {
+      delete txn;
+    }
+    delete txn_manager;
+    delete lock_manager;
+    delete log_manager;
+    delete disk_manager;
+  }
+  EXPECT_LT(2 * num_flushes[1], num_flushes[0]);
+}
+
+// NOLINTNEXTLINE
+TEST(LogManagerTest, FullBufferTest) {
+  MemoryDiskManager disk_manager;
+  auto *log_manager = new LogManager(&disk_manager);
+
+  // Scenario: a record larger than the whole log buffer is refused instead of waiting for room forever.
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, LOG_BUFFER_SIZE}}};
+  Tuple tuple({ValueFactory::GetVarcharValue(std::string(LOG_BUFFER_SIZE, 'x'))}, &schema);
+  LogRecord insert(0, INVALID_LSN, LogRecordType::INSERT, RID(0, 0), tuple);
+  EXPECT_THROW(log_manager->AppendLogRecord(&insert), Exception);
+
+  // Scenario: without a flush thread a full log buffer is refused as well, with one the record waits for a flush.
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  const int records_per_buffer = LOG_BUFFER_SIZE / begin.GetSize();
+  for (int i = 0; i < records_per_buffer; ++i) {
+    EXPECT_EQ(i, log_manager->AppendLogRecord(&begin));
+  }
+  EXPECT_THROW(log_manager->AppendLogRecord(&begin), Exception);
+  log_manager->RunFlushThread();
+  lsn_t lsn = log_manager->AppendLogRecord(&begin);
+  EXPECT_EQ(records_per_buffer, lsn);
+  log_manager->StopFlushThread();
+  EXPECT_EQ(lsn, log_manager->GetPersistentLSN());
+  EXPECT_EQ(2, disk_manager.GetNumFlushes());
+
+  delete log_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_engine_test.cpp
+//
+// Identification: test/storage/async_io_engine_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/async_io_engine.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(AsyncIOEngineTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 64;
+  remove(db_name.c_str());
+  int fd = open(db_name.c_str(), O_RDWR | O_CREAT, 0644);
+  ASSERT_NE(-1, fd);
+
+  std::vector<AsyncIOEngine *> engines{AsyncIOEngine::CreateThreadPool(fd, 8, 4)};
+  AsyncIOEngine *io_uring = AsyncIOEngine::CreateIoUring(fd, 8);
+  if (io_uring != nullptr) {
+    engines.push_back(io_uring);
+  }
+  for (auto *engine : engines) {
+    // Scenario: more writes than the queue depth are submitted, then read back.
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+    std::atomic<int> succeeded{0};
+    for (int i = 0; i < num_pages; ++i) {
+      snprintf(pages[i].data(), PAGE_SIZE, "%s %d", engine->GetName(), i);
+      engine->Submit({true, pages[i].data(), PAGE_SIZE, static_cast<off_t>(i) * PAGE_SIZE,
+                      [&](bool success) { succeeded += success ? 1 : 0; }});
+    }
+    engine->Wait();
+    EXPECT_EQ(num_pages, succeeded);
+    for (auto &page : pages) {
+      memset(page.data(), 'x', PAGE_SIZE);
+    }
+    for (int i = 0; i < num_pages; ++i) {
+      engine->Submit({false, pages[i].data(), PAGE_SIZE, static_cast<off_t>(i) * PAGE_SIZE,
+                      [&](bool success) { succeeded += success ? 1 : 0; }});
+    }
+    engine->Wait();
+    EXPECT_EQ(2 * num_pages, succeeded);
+    for (int i = 0; i < num_pages; ++i) {
+      EXPECT_EQ(std::string(engine->GetName()) + " " + std::to_string(i), std::string(pages[i].data()));
+    }
+
+    // Scenario: a read past the end of the file succeeds with zeroes.
+    engine->Submit({false, pages[0].data(), PAGE_SIZE, static_cast<off_t>(num_pages) * PAGE_SIZE,
+                    [&](bool success) { EXPECT_TRUE(success); }});
+    engine->Wait();
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), pages[0]);
+    delete engine;
+  }
+
+  close(fd);
+  remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncIOEngineTest, DiskManagerTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: pages written asynchronously read back both ways.
+  std::vector<char> data(PAGE_SIZE);
+  snprintf(data.data(), PAGE_SIZE, "Hello");
+  std::atomic<bool> written{false};
+  disk_manager->WritePageAsync(3, data.data(), [&](bool success) { written = success; });
+  disk_manager->WaitForAsyncIO();
+  EXPECT_TRUE(written);
+
+  std::vector<char> buffer(PAGE_SIZE);
+  disk_manager->ReadPage(3, buffer.data());
+  EXPECT_EQ("Hello", std::string(buffer.data()));
+  memset(buffer.data(), 0, PAGE_SIZE);
+  disk_manager->ReadPageAsync(3, buffer.data(), nullptr);
+  disk_manager->WaitForAsyncIO();
+  EXPECT_EQ("Hello", std::string(buffer.data()));
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  EXPECT_EQ(2, disk_manager->GetNumReads());
+
+  std::string backend = disk_manager->GetAsyncIOBackend();
+  EXPECT_TRUE(backend == "io_uring" || backend == "thread pool");
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncIOEngineTest, BenchmarkTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 1024;
+  const int num_reads = 4096;
+  remove(db_name.c_str());
+  int fd = open(db_name.c_str(), O_RDWR | O_CREAT, 0644);
+  ASSERT_NE(-1, fd);
+  std::vector<char> page(PAGE_SIZE, 'a');
+  for (int i = 0; i < num_pages; ++i) {
+    ASSERT_EQ(PAGE_SIZE, pwrite(fd, page.data(), PAGE_SIZE, static_cast<off_t>(i) * PAGE_SIZE));
+  }
+
+  // Scenario: random page reads at queue depth 1 and 32, on every backend available.
+  for (size_t queue_depth : {1, 32}) {
+    std::vector<AsyncIOEngine *> engines{AsyncIOEngine::CreateThreadPool(fd, queue_depth, queue_depth)};
+    AsyncIOEngine *io_uring = AsyncIOEngine::CreateIoUring(fd, queue_depth);
+    if (io_uring != nullptr) {
+      engines.push_back(io_uring);
+    }
+    for (auto *engine : engines) {
+      std::vector<std::vector<char>> buffers(queue_depth, std::vector<char>(PAGE_SIZE));
+      std::mt19937 random(0);
+      std::atomic<int> succeeded{0};
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_reads; ++i) {
+        off_t offset = static_cast<off_t>(random() % num_pages) * PAGE_SIZE;
+        engine->Submit({false, buffers[i % queue_depth].data(), PAGE_SIZE, offset,
+                        [&](bool success) { succeeded += success ? 1 : 0; }});
+      }
+      engine->Wait();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      EXPECT_EQ(num_reads, succeeded);
+      printf("[BENCHMARK] %s, queue depth %zu: %.0f IOPS\n", engine->GetName(), queue_depth,
+             num_reads / elapsed.count());
+      delete engine;
+    }
+  }
+
+  close(fd);
+  remove(db_name.c_str());
+}
+
+}  // namespace bustub
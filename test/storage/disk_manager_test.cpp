@@ -0,0 +1,351 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_test.cpp
+//
+// Identification: test/storage/disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/stat.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/page_allocator.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, ConcurrentReadWriteTest) {
+  const std::string db_name = "test.db";
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: threads write their own pages at the same time, then read them back at the same time.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([disk_manager, t]() {
+      std::vector<char> data(PAGE_SIZE);
+      for (int i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id = i * num_threads + t;
+        memset(data.data(), 'a' + t, PAGE_SIZE);
+        snprintf(data.data(), PAGE_SIZE, "Page %d", page_id);
+        disk_manager->WritePage(page_id, data.data());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([disk_manager, t]() {
+      std::vector<char> data(PAGE_SIZE);
+      for (int i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id = i * num_threads + t;
+        disk_manager->ReadPage(page_id, data.data());
+        ASSERT_EQ("Page " + std::to_string(page_id), std::string(data.data()));
+        ASSERT_EQ('a' + t, data[PAGE_SIZE - 1]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, disk_manager->GetNumWrites());
+  EXPECT_EQ(num_threads * pages_per_thread, disk_manager->GetNumReads());
+
+  // Scenario: writes are only synced on request.
+  EXPECT_EQ(0, disk_manager->GetNumSyncs());
+  disk_manager->Sync();
+  EXPECT_EQ(1, disk_manager->GetNumSyncs());
+
+  // Scenario: a run of pages reads back with vectored reads, the part past the end of the file as zeroes.
+  std::vector<std::vector<char>> run(4, std::vector<char>(PAGE_SIZE, 'x'));
+  std::vector<char *> run_data;
+  for (auto &data : run) {
+    run_data.push_back(data.data());
+  }
+  page_id_t last_page_id = num_threads * pages_per_thread - 1;
+  disk_manager->ReadPages(last_page_id - 1, run_data.data(), run_data.size());
+  EXPECT_EQ("Page " + std::to_string(last_page_id - 1), std::string(run[0].data()));
+  EXPECT_EQ("Page " + std::to_string(last_page_id), std::string(run[1].data()));
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), run[2]);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), run[3]);
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, DirectIOTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, true);
+
+  // Scenario: aligned and unaligned buffers both read and write pages, with or without a file system that supports
+  // direct I/O.
+  auto *aligned = static_cast<char *>(aligned_alloc(PAGE_SIZE, 2 * PAGE_SIZE));
+  std::vector<char> storage(PAGE_SIZE + 1);
+  char *unaligned = storage.data() + (reinterpret_cast<uintptr_t>(storage.data()) % PAGE_SIZE == 0 ? 1 : 0);
+  snprintf(aligned, PAGE_SIZE, "Aligned");
+  snprintf(unaligned, PAGE_SIZE, "Unaligned");
+  disk_manager->WritePage(0, aligned);
+  disk_manager->WritePage(1, unaligned);
+  disk_manager->ReadPage(1, aligned);
+  disk_manager->ReadPage(0, unaligned);
+  EXPECT_EQ("Unaligned", std::string(aligned));
+  EXPECT_EQ("Aligned", std::string(unaligned));
+
+  char *run[] = {unaligned, aligned + PAGE_SIZE};
+  disk_manager->WritePages(2, run, 2);
+  memset(aligned, 0, 2 * PAGE_SIZE);
+  char *read_run[] = {aligned, unaligned, aligned + PAGE_SIZE};
+  disk_manager->ReadPages(1, read_run, 3);
+  EXPECT_EQ("Unaligned", std::string(aligned));
+  EXPECT_EQ("Aligned", std::string(unaligned));
+
+  bool read = false;
+  disk_manager->ReadPageAsync(0, unaligned, [&](bool success) { read = success; });
+  disk_manager->WaitForAsyncIO();
+  EXPECT_TRUE(read);
+  EXPECT_EQ("Aligned", std::string(unaligned));
+
+  // Scenario: the buffer pool reads and writes its frames directly.
+  auto *bpm = new BufferPoolManager(2, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < 4; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  for (page_id_t i = 0; i < 4; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Page " + std::to_string(i), std::string(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+  free(aligned);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, CompressionTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(".", &stat_buf));
+  size_t block_size = 0;
+  if (2 * static_cast<size_t>(stat_buf.st_blksize) > PAGE_SIZE) {
+    // Scenario: compression is refused where no compressed page could free a file system block. The rest of the test
+    // lays pages out for smaller blocks, which works on any file system.
+    EXPECT_THROW(DiskManager(db_name, false, true), Exception);
+    remove(db_name.c_str());
+    block_size = PAGE_SIZE / 4;
+  }
+  auto *disk_manager = new DiskManager(db_name, false, true, block_size);
+  EXPECT_TRUE(disk_manager->UsesPageCompression());
+
+  // Scenario: a compressible page is stored in fewer whole sectors, an incompressible one as it is.
+  std::vector<char> text(PAGE_SIZE, 0);
+  snprintf(text.data(), PAGE_SIZE, "Hello, compressed world");
+  std::vector<char> noise(PAGE_SIZE);
+  std::mt19937 random(0);
+  for (auto &byte : noise) {
+    byte = static_cast<char>(random());
+  }
+  disk_manager->WritePage(0, text.data());
+  disk_manager->WritePage(1, noise.data());
+  EXPECT_GT(PAGE_SIZE, disk_manager->GetStoredPageSize(0));
+  EXPECT_EQ(0, disk_manager->GetStoredPageSize(0) % 512);
+  EXPECT_EQ(PAGE_SIZE, disk_manager->GetStoredPageSize(1));
+
+  std::vector<char> data(PAGE_SIZE);
+  disk_manager->ReadPage(0, data.data());
+  EXPECT_EQ(text, data);
+  disk_manager->ReadPage(1, data.data());
+  EXPECT_EQ(noise, data);
+
+  // Scenario: runs of pages and asynchronous requests compress as well.
+  const char *run[] = {noise.data(), text.data()};
+  disk_manager->WritePages(2, run, 2);
+  bool written = false;
+  disk_manager->WritePageAsync(4, text.data(), [&](bool success) { written = success; });
+  disk_manager->WaitForAsyncIO();
+  EXPECT_TRUE(written);
+  EXPECT_GT(PAGE_SIZE, disk_manager->GetStoredPageSize(4));
+  std::vector<std::vector<char>> read_run(3, std::vector<char>(PAGE_SIZE));
+  char *read_run_data[] = {read_run[0].data(), read_run[1].data(), read_run[2].data()};
+  disk_manager->ReadPages(2, read_run_data, 3);
+  EXPECT_EQ(noise, read_run[0]);
+  EXPECT_EQ(text, read_run[1]);
+  EXPECT_EQ(text, read_run[2]);
+  bool read = false;
+  disk_manager->ReadPageAsync(3, data.data(), [&](bool success) { read = success; });
+  disk_manager->WaitForAsyncIO();
+  EXPECT_TRUE(read);
+  EXPECT_EQ(text, data);
+
+  // Scenario: a page that shrinks leaves no trace of its larger image.
+  disk_manager->WritePage(1, text.data());
+  disk_manager->ReadPage(1, data.data());
+  EXPECT_EQ(text, data);
+
+  // Scenario: a page stored as it is that starts like a compressed image whose checksum does not match is still read
+  // as it is.
+  size_t text_size = disk_manager->GetStoredPageSize(0);
+  std::vector<char> lookalike(noise);
+  std::ifstream db_file(db_name, std::ios::binary);
+  db_file.seekg(static_cast<std::streamoff>(PageAllocator::GetPhysicalPage(0) * PAGE_SIZE));
+  db_file.read(lookalike.data(), static_cast<std::streamsize>(text_size));
+  db_file.close();
+  lookalike[16] = static_cast<char>(~lookalike[16]);
+  disk_manager->WritePage(5, lookalike.data());
+  disk_manager->ReadPage(5, data.data());
+  EXPECT_EQ(lookalike, data);
+
+  // Scenario: the stored size map is kept in the file, so the sizes are known after reopening.
+  disk_manager->ShutDown();
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name, false, true, block_size);
+  EXPECT_EQ(text_size, disk_manager->GetStoredPageSize(0));
+  EXPECT_EQ(PAGE_SIZE, disk_manager->GetStoredPageSize(2));
+  disk_manager->ReadPage(0, data.data());
+  EXPECT_EQ(text, data);
+  disk_manager->ReadPage(2, data.data());
+  EXPECT_EQ(noise, data);
+  disk_manager->ReadPage(5, data.data());
+  EXPECT_EQ(lookalike, data);
+
+  // Scenario: pages change how they are stored, and a copy of the file taken before the next sync stands for the file
+  // after a crash, whose stored size map does not know about the changes.
+  const std::string crash_name = "test_crash.db";
+  disk_manager->WritePage(0, noise.data());
+  disk_manager->WritePage(2, text.data());
+  disk_manager->WritePage(6, text.data());
+  {
+    std::ifstream source(db_name, std::ios::binary);
+    std::ofstream copy(crash_name, std::ios::binary | std::ios::trunc);
+    copy << source.rdbuf();
+  }
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: the images are recognized by their content, the map only tells how much to read.
+  disk_manager = new DiskManager(crash_name, false, true, block_size);
+  EXPECT_EQ(text_size, disk_manager->GetStoredPageSize(0));
+  EXPECT_EQ(PAGE_SIZE, disk_manager->GetStoredPageSize(2));
+  disk_manager->ReadPage(0, data.data());
+  EXPECT_EQ(noise, data);
+  EXPECT_EQ(PAGE_SIZE, disk_manager->GetStoredPageSize(0));
+  read = false;
+  disk_manager->ReadPageAsync(2, data.data(), [&](bool success) { read = success; });
+  disk_manager->WaitForAsyncIO();
+  EXPECT_TRUE(read);
+  EXPECT_EQ(text, data);
+  EXPECT_GT(PAGE_SIZE, disk_manager->GetStoredPageSize(2));
+  char *read_data[] = {read_run[0].data()};
+  disk_manager->ReadPages(6, read_data, 1);
+  EXPECT_EQ(text, read_run[0]);
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(crash_name.c_str());
+  remove("test_crash.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, MetricsTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: page I/O, syncs and log I/O are counted per file, with their bytes and latencies.
+  std::vector<char> data(PAGE_SIZE, 'a');
+  disk_manager->WritePage(0, data.data());
+  const char *run[] = {data.data(), data.data(), data.data()};
+  disk_manager->WritePages(1, run, 3);
+  disk_manager->ReadPage(0, data.data());
+  disk_manager->Sync();
+  char log_data[] = "log record";
+  disk_manager->WriteLog(log_data, sizeof(log_data));
+  char log_buffer[sizeof(log_data)];
+  EXPECT_TRUE(disk_manager->ReadLog(log_buffer, sizeof(log_buffer), 0));
+
+  DiskManagerMetrics metrics = disk_manager->GetMetrics();
+  EXPECT_EQ(2, metrics.data_.writes_);
+  EXPECT_EQ(4 * PAGE_SIZE, metrics.data_.bytes_written_);
+  EXPECT_EQ(1, metrics.data_.reads_);
+  EXPECT_EQ(PAGE_SIZE, metrics.data_.bytes_read_);
+  EXPECT_EQ(1, metrics.data_.syncs_);
+  EXPECT_EQ(2, metrics.data_.write_latency_.count_);
+  EXPECT_EQ(1, metrics.data_.sync_latency_.count_);
+  EXPECT_EQ(1, metrics.log_.writes_);
+  EXPECT_EQ(sizeof(log_data), metrics.log_.bytes_written_);
+  EXPECT_EQ(1, metrics.log_.reads_);
+  EXPECT_EQ(1, metrics.log_.syncs_);
+  EXPECT_EQ(metrics.log_.writes_, disk_manager->GetNumFlushes());
+  EXPECT_NE(std::string::npos, metrics.ToString().find("data_writes 2\n"));
+  EXPECT_NE(std::string::npos, metrics.ToString().find("log_write_p99_ns "));
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, PageSizeTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+
+  // Scenario: a new db file records the page size of the build in its header.
+  auto *disk_manager = new DiskManager(db_name);
+  disk_manager->ShutDown();
+  delete disk_manager;
+  FILE *file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  uint32_t header[2];
+  ASSERT_EQ(2, fread(header, sizeof(uint32_t), 2, file));
+  EXPECT_EQ(PAGE_SIZE, header[1]);
+
+  // Scenario: a db file created with another page size is refused.
+  header[1] = PAGE_SIZE * 2;
+  fseek(file, 0, SEEK_SET);
+  ASSERT_EQ(2, fwrite(header, sizeof(uint32_t), 2, file));
+  fclose(file);
+  EXPECT_THROW(DiskManager{db_name}, Exception);
+
+  // Scenario: a file that is not a db file is refused rather than overwritten.
+  file = fopen(db_name.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  fputs("not a database", file);
+  fclose(file);
+  EXPECT_THROW(DiskManager{db_name}, Exception);
+
+  remove(db_name.c_str());
+}
+
+}  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_disk_manager_test.cpp
+//
+// Identification: test/storage/memory_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/memory_disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MemoryDiskManagerTest, SampleTest) {
+  MemoryDiskManager disk_manager;
+  std::vector<char> data(PAGE_SIZE);
+  std::vector<char> buffer(PAGE_SIZE, 'x');
+
+  // Scenario: pages read back what was written, a page that was never written reads as zeroes.
+  snprintf(data.data(), PAGE_SIZE, "Hello");
+  disk_manager.WritePage(100, data.data());
+  disk_manager.ReadPage(100, buffer.data());
+  EXPECT_EQ(data, buffer);
+  disk_manager.ReadPage(7, buffer.data());
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), buffer);
+  EXPECT_EQ(1, disk_manager.GetNumStoredPages());
+
+  // Scenario: runs and asynchronous requests go to the same pages, the callback runs before the call returns.
+  std::vector<char> other(PAGE_SIZE, 'o');
+  const char *run[] = {other.data(), data.data()};
+  disk_manager.WritePages(1, run, 2);
+  bool read = false;
+  disk_manager.ReadPageAsync(2, buffer.data(), [&](bool success) { read = success; });
+  EXPECT_TRUE(read);
+  EXPECT_EQ(data, buffer);
+  disk_manager.WritePageAsync(2, other.data(), nullptr);
+  disk_manager.WaitForAsyncIO();
+  char *pages[] = {data.data(), buffer.data()};
+  disk_manager.ReadPages(1, pages, 2);
+  EXPECT_EQ(other, data);
+  EXPECT_EQ(other, buffer);
+  EXPECT_EQ(3, disk_manager.GetNumWrites());
+  EXPECT_EQ(4, disk_manager.GetNumReads());
+  EXPECT_STREQ("memory", disk_manager.GetAsyncIOBackend());
+
+  // Scenario: a run that overwrites a stored page and adds a new one, while other threads write pages of their own.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([&disk_manager, tid] {
+      std::vector<char> page(PAGE_SIZE, static_cast<char>('a' + tid));
+      // the first pass adds the pages, the second one overwrites them
+      for (int i = 0; i < 200; ++i) {
+        disk_manager.WritePage(200 + tid * 100 + i % 100, page.data());
+      }
+    });
+  }
+  const char *grow_run[] = {data.data(), other.data()};
+  snprintf(data.data(), PAGE_SIZE, "Grown");
+  disk_manager.WritePages(2, grow_run, 2);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  disk_manager.ReadPage(2, buffer.data());
+  EXPECT_EQ(data, buffer);
+  disk_manager.ReadPage(3, buffer.data());
+  EXPECT_EQ(other, buffer);
+  disk_manager.ReadPage(300, buffer.data());
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'b'), buffer);
+
+  // Scenario: two threads overwrite the same page while a third reads it, every read sees one whole write.
+  threads.clear();
+  for (int tid = 0; tid < 2; ++tid) {
+    threads.emplace_back([&disk_manager, tid] {
+      std::vector<char> page(PAGE_SIZE, static_cast<char>('x' + tid));
+      for (int i = 0; i < 1000; ++i) {
+        disk_manager.WritePage(300, page.data());
+      }
+    });
+  }
+  for (int i = 0; i < 1000; ++i) {
+    disk_manager.ReadPage(300, buffer.data());
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, buffer[0]), buffer);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: the log is appended to and read back at any offset, past its end the read fails.
+  char log_data[] = "first record second record";
+  disk_manager.WriteLog(log_data, 13);
+  disk_manager.WriteLog(log_data + 13, 13);
+  EXPECT_EQ(2, disk_manager.GetNumFlushes());
+  char log_buffer[16];
+  ASSERT_TRUE(disk_manager.ReadLog(log_buffer, sizeof(log_buffer), 13));
+  EXPECT_EQ("second record", std::string(log_buffer));
+  EXPECT_FALSE(disk_manager.ReadLog(log_buffer, sizeof(log_buffer), 26));
+
+  // Scenario: pages are allocated and reused like on disk.
+  EXPECT_EQ(0, disk_manager.AllocatePage());
+  EXPECT_EQ(1, disk_manager.AllocatePage());
+  disk_manager.DeallocatePage(0);
+  EXPECT_EQ(0, disk_manager.AllocatePage());
+}
+
+// NOLINTNEXTLINE
+TEST(MemoryDiskManagerTest, BustubInstanceTest) {
+  const std::string db_name = "memory.db";
+  remove(db_name.c_str());
+  auto *bustub_instance = new BustubInstance(db_name, true);
+  auto *bpm = bustub_instance->buffer_pool_manager_;
+
+  // Scenario: pages evicted from the buffer pool come back from memory, and no file is created.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 4 * BUFFER_POOL_MAX_SIZE; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Page " + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_LT(0, bustub_instance->disk_manager_->GetNumWrites());
+  EXPECT_EQ(nullptr, fopen(db_name.c_str(), "r"));
+  delete bustub_instance;
+
+  // Scenario: the buffer pool starts at the size given to the instance, and the instance resizes it.
+  bustub_instance = new BustubInstance(db_name, true, 4 * BUFFER_POOL_CHUNK_SIZE);
+  EXPECT_EQ(4 * BUFFER_POOL_CHUNK_SIZE, bustub_instance->buffer_pool_manager_->GetPoolSize());
+  EXPECT_EQ(8 * BUFFER_POOL_CHUNK_SIZE, bustub_instance->ResizeBufferPool(8 * BUFFER_POOL_CHUNK_SIZE));
+  EXPECT_EQ(4 * BUFFER_POOL_CHUNK_SIZE, bustub_instance->ResizeBufferPool(4 * BUFFER_POOL_CHUNK_SIZE));
+  delete bustub_instance;
+}
+
+}  // namespace bustub
@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_allocator_test.cpp
+//
+// Identification: test/storage/page_allocator_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/page_allocator.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageAllocatorTest, SampleTest) {
+  PageAllocator allocator;
+
+  // Scenario: pages are handed out in order, deallocated ones are reused lowest first.
+  for (page_id_t i = 0; i < 20; ++i) {
+    EXPECT_EQ(i, allocator.Allocate());
+  }
+  allocator.Deallocate(12);
+  allocator.Deallocate(5);
+  allocator.Deallocate(5);
+  EXPECT_FALSE(allocator.IsAllocated(5));
+  EXPECT_TRUE(allocator.IsAllocated(6));
+  EXPECT_EQ(18, allocator.GetNumAllocated());
+  EXPECT_EQ(5, allocator.Allocate());
+  EXPECT_EQ(12, allocator.Allocate());
+  EXPECT_EQ(20, allocator.Allocate());
+
+  // Scenario: a full group is followed by a new one, whose data pages come after its bitmap and stored size map pages.
+  while (allocator.GetNumAllocated() < static_cast<size_t>(PageAllocator::PAGES_PER_GROUP)) {
+    allocator.Allocate();
+  }
+  EXPECT_EQ(PageAllocator::PAGES_PER_GROUP, allocator.Allocate());
+  const size_t map_pages = PageAllocator::SIZE_MAP_PAGES_PER_GROUP;
+  EXPECT_EQ(1, PageAllocator::GetBitmapPhysicalPage(0));
+  EXPECT_EQ(2, PageAllocator::GetSizeMapPhysicalPage(0));
+  EXPECT_EQ(map_pages + 2, PageAllocator::GetPhysicalPage(0));
+  EXPECT_EQ(map_pages + PageAllocator::PAGES_PER_GROUP + 2, PageAllocator::GetBitmapPhysicalPage(1));
+  EXPECT_EQ(2 * map_pages + PageAllocator::PAGES_PER_GROUP + 3,
+            PageAllocator::GetPhysicalPage(PageAllocator::PAGES_PER_GROUP));
+
+  // Scenario: only the bitmap pages that changed are written back, and they load into an equal allocator.
+  auto dirty_groups = allocator.TakeDirtyGroups();
+  ASSERT_EQ(2, dirty_groups.size());
+  EXPECT_TRUE(allocator.TakeDirtyGroups().empty());
+  allocator.Deallocate(7);
+  ASSERT_EQ(1, allocator.TakeDirtyGroups().size());
+
+  PageAllocator loaded;
+  loaded.LoadGroup(dirty_groups[0].second.data());
+  loaded.LoadGroup(dirty_groups[1].second.data());
+  EXPECT_EQ(PageAllocator::PAGES_PER_GROUP + 1, loaded.GetNumAllocated());
+  EXPECT_TRUE(loaded.IsAllocated(7));
+  EXPECT_EQ(PageAllocator::PAGES_PER_GROUP + 1, loaded.Allocate());
+}
+
+// NOLINTNEXTLINE
+TEST(PageAllocatorTest, ExtentTest) {
+  PageAllocator allocator;
+
+  // Scenario: reserved pages are skipped by allocations, and only marked in the bitmap once they are allocated.
+  EXPECT_EQ(0, allocator.Allocate());
+  EXPECT_EQ(1, allocator.Reserve(8));
+  EXPECT_EQ(9, allocator.Allocate());
+  EXPECT_EQ(10, allocator.Reserve(8));
+  allocator.AllocateReserved(1);
+  allocator.AllocateReserved(10);
+  EXPECT_TRUE(allocator.IsAllocated(1));
+  EXPECT_FALSE(allocator.IsAllocated(2));
+  EXPECT_EQ(4, allocator.GetNumAllocated());
+
+  // Scenario: an extent only fits where enough consecutive pages are free.
+  allocator.Deallocate(0);
+  EXPECT_EQ(18, allocator.Reserve(2));
+  EXPECT_EQ(0, allocator.Allocate());
+
+  // Scenario: reservations are not persistent, the unused pages are free after a reload.
+  PageAllocator loaded;
+  loaded.LoadGroup(allocator.TakeDirtyGroups()[0].second.data());
+  EXPECT_EQ(4, loaded.GetNumAllocated());
+  EXPECT_EQ(2, loaded.Allocate());
+}
+
+// NOLINTNEXTLINE
+TEST(PageAllocatorTest, BufferPoolManagerExtentTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(10, disk_manager);
+
+  // Scenario: two objects that grow in turns still get consecutive pages each.
+  PageExtent first_extent(4);
+  PageExtent second_extent(4);
+  std::vector<page_id_t> first_pages;
+  std::vector<page_id_t> second_pages;
+  page_id_t page_id;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPageInExtent(&page_id, &first_extent));
+    bpm->UnpinPage(page_id, false);
+    first_pages.push_back(page_id);
+    ASSERT_NE(nullptr, bpm->NewPageInExtent(&page_id, &second_extent));
+    bpm->UnpinPage(page_id, false);
+    second_pages.push_back(page_id);
+  }
+  EXPECT_EQ((std::vector<page_id_t>{0, 1, 2, 3, 8, 9}), first_pages);
+  EXPECT_EQ((std::vector<page_id_t>{4, 5, 6, 7, 12, 13}), second_pages);
+
+  // Scenario: pages created on their own do not take pages of an extent.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(16, page_id);
+  bpm->UnpinPage(page_id, false);
+
+  // Scenario: a page the buffer pool had no frame for stays in the extent.
+  std::vector<page_id_t> pinned;
+  while (bpm->NewPage(&page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPageInExtent(&page_id, &first_extent));
+  bpm->UnpinPage(pinned.back(), false);
+  ASSERT_NE(nullptr, bpm->NewPageInExtent(&page_id, &first_extent));
+  EXPECT_EQ(10, page_id);
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageAllocatorTest, DiskManagerTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+
+  // Scenario: deleted pages of the buffer pool are reused, and the allocation survives reopening the file.
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(10, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < 5; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  EXPECT_TRUE(bpm->DeletePage(2));
+  EXPECT_FALSE(disk_manager->IsPageAllocated(2));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(2, page_id);
+  bpm->UnpinPage(page_id, false);
+  EXPECT_TRUE(bpm->DeletePage(3));
+  bpm->FlushAllPages();
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+
+  disk_manager = new DiskManager(db_name);
+  EXPECT_TRUE(disk_manager->IsPageAllocated(4));
+  EXPECT_FALSE(disk_manager->IsPageAllocated(3));
+  std::vector<char> data(PAGE_SIZE);
+  disk_manager->ReadPage(4, data.data());
+  EXPECT_EQ("Page 4", std::string(data.data()));
+  EXPECT_EQ(3, disk_manager->AllocatePage());
+  EXPECT_EQ(5, disk_manager->AllocatePage());
+
+  // Scenario: a disk manager that is destroyed without being shut down still keeps its allocations and pages.
+  snprintf(data.data(), PAGE_SIZE, "Page 5");
+  disk_manager->WritePage(5, data.data());
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_TRUE(disk_manager->IsPageAllocated(3));
+  EXPECT_TRUE(disk_manager->IsPageAllocated(5));
+  disk_manager->ReadPage(5, data.data());
+  EXPECT_EQ("Page 5", std::string(data.data()));
+  EXPECT_EQ(6, disk_manager->AllocatePage());
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_test.cpp
+//
+// Identification: test/storage/page_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTest, OptimisticLatchTest) {
+  Page page;
+  uint64_t version;
+
+  // Scenario: a read without writers validates.
+  EXPECT_TRUE(page.TryOptimisticRLatch(&version));
+  EXPECT_TRUE(page.ValidateOptimisticRLatch(version));
+
+  // Scenario: a read that overlaps a write does not validate.
+  EXPECT_TRUE(page.TryOptimisticRLatch(&version));
+  page.WLatch();
+  page.WUnlatch();
+  EXPECT_FALSE(page.ValidateOptimisticRLatch(version));
+
+  // Scenario: a read cannot start while the write latch is held, but readers using the latch are unaffected.
+  page.WLatch();
+  EXPECT_FALSE(page.TryOptimisticRLatch(&version));
+  page.WUnlatch();
+  EXPECT_TRUE(page.TryOptimisticRLatch(&version));
+  page.RLatch();
+  page.RUnlatch();
+  EXPECT_TRUE(page.ValidateOptimisticRLatch(version));
+}
+
+// NOLINTNEXTLINE
+TEST(PageTest, ConcurrentOptimisticReadTest) {
+  const int num_writes = 2000;
+  const int num_readers = 4;
+  Page page;
+  std::atomic<bool> done{false};
+
+  // Scenario: a writer keeps overwriting the whole page with a single repeated byte.
+  std::thread writer([&]() {
+    for (int i = 0; i < num_writes; ++i) {
+      page.WLatch();
+      memset(page.GetData(), 'a' + i % 26, PAGE_SIZE);
+      page.WUnlatch();
+    }
+    done = true;
+  });
+
+  // Scenario: every validated optimistic copy is one of the writer's pages, never a mix of two.
+  std::vector<std::thread> readers;
+  std::atomic<int> validated{0};
+  for (int r = 0; r < num_readers; ++r) {
+    readers.emplace_back([&]() {
+      std::vector<char> copy(PAGE_SIZE);
+      do {
+        uint64_t version;
+        if (!page.TryOptimisticRLatch(&version)) {
+          continue;
+        }
+        memcpy(copy.data(), page.GetData(), PAGE_SIZE);
+        if (page.ValidateOptimisticRLatch(version)) {
+          validated++;
+          for (char c : copy) {
+            ASSERT_EQ(copy[0], c);
+          }
+        }
+      } while (!done);
+    });
+  }
+
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_LT(0, validated);
+}
+
+}  // namespace bustub
@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simulated_disk_manager_test.cpp
+//
+// Identification: test/storage/simulated_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_metrics.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/simulated_disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+// NOLINTNEXTLINE
+TEST(SimulatedDiskManagerTest, SampleTest) {
+  MemoryDiskManager memory;
+  SimulatedDiskProfile profile;
+  profile.write_ = {milliseconds(5), 0};
+  auto *disk_manager = new SimulatedDiskManager(&memory, profile);
+
+  // Scenario: an operation takes at least its latency, and reaches the wrapped disk manager.
+  std::vector<char> data(PAGE_SIZE);
+  snprintf(data.data(), PAGE_SIZE, "Hello");
+  page_id_t page_id = disk_manager->AllocatePage();
+  EXPECT_TRUE(memory.IsPageAllocated(page_id));
+  auto start = steady_clock::now();
+  disk_manager->WritePage(page_id, data.data());
+  EXPECT_LE(milliseconds(5), steady_clock::now() - start);
+  std::vector<char> buffer(PAGE_SIZE);
+  memory.ReadPage(page_id, buffer.data());
+  EXPECT_EQ(data, buffer);
+
+  // Scenario: asynchronous requests complete after their latency as well.
+  start = steady_clock::now();
+  bool written = false;
+  disk_manager->WritePageAsync(page_id, data.data(), [&](bool success) { written = success; });
+  disk_manager->WaitForAsyncIO();
+  EXPECT_TRUE(written);
+  EXPECT_LE(milliseconds(5), steady_clock::now() - start);
+  EXPECT_EQ(2, disk_manager->GetNumWrites());
+  delete disk_manager;
+
+  // Scenario: asynchronous requests wait out their latency together instead of holding up the I/O engine.
+  const int num_reads = 64;
+  profile = SimulatedDiskProfile();
+  profile.read_ = {milliseconds(20), 0};
+  disk_manager = new SimulatedDiskManager(&memory, profile);
+  std::vector<std::vector<char>> reads(num_reads, std::vector<char>(PAGE_SIZE));
+  std::atomic<int> num_read{0};
+  start = steady_clock::now();
+  for (int i = 0; i < num_reads; i++) {
+    disk_manager->ReadPageAsync(page_id, reads[i].data(), [&](bool success) { num_read += success ? 1 : 0; });
+  }
+  EXPECT_GT(milliseconds(20), steady_clock::now() - start);
+  disk_manager->WaitForAsyncIO();
+  EXPECT_EQ(num_reads, num_read);
+  EXPECT_LE(milliseconds(20), steady_clock::now() - start);
+  EXPECT_GT(milliseconds(num_reads / 4 * 20), steady_clock::now() - start);
+  delete disk_manager;
+
+  // Scenario: transfers queue up on the bandwidth, 4 pages at 200 pages a second take 20ms.
+  profile = SimulatedDiskProfile();
+  profile.bandwidth_ = 200 * PAGE_SIZE;
+  disk_manager = new SimulatedDiskManager(&memory, profile);
+  char *pages[] = {buffer.data(), buffer.data(), buffer.data(), buffer.data()};
+  start = steady_clock::now();
+  disk_manager->ReadPages(0, pages, 4);
+  EXPECT_LE(milliseconds(20), steady_clock::now() - start);
+  delete disk_manager;
+
+  // Scenario: a stall adds to the latency of an operation.
+  profile = SimulatedDiskProfile();
+  profile.stall_probability_ = 1;
+  profile.stall_ = milliseconds(5);
+  disk_manager = new SimulatedDiskManager(&memory, profile);
+  start = steady_clock::now();
+  disk_manager->ReadPage(page_id, buffer.data());
+  EXPECT_LE(milliseconds(5), steady_clock::now() - start);
+  EXPECT_EQ(1, disk_manager->GetNumStalls());
+  EXPECT_EQ(data, buffer);
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(SimulatedDiskManagerTest, BenchmarkTest) {
+  const int num_txns = 200;
+  const int tuples_per_txn = 10;
+  const int num_queries = 20;
+  const size_t buffer_pool_size = 64;
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 32};
+  Schema schema{std::vector<Column>{col1, col2}};
+
+  // Scenario: small inserting transactions that force their pages to disk when they commit, then full table scans on a
+  // cold buffer pool.
+  std::vector<std::pair<std::string, SimulatedDiskProfile>> profiles{
+      {"memory", SimulatedDiskProfile()},
+      {"ssd", SimulatedDiskProfile::Ssd()},
+      {"network storage", SimulatedDiskProfile::NetworkStorage()}};
+  for (auto &[name, profile] : profiles) {
+    MemoryDiskManager memory;
+    auto *disk_manager = new SimulatedDiskManager(&memory, profile);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto *lock_manager = new LockManager(TwoPLMode::STRICT, DeadlockMode::PREVENTION);
+    auto *log_manager = new LogManager(disk_manager);
+    auto *txn_manager = new TransactionManager(lock_manager, log_manager);
+
+    Transaction *txn = txn_manager->Begin();
+    auto *table = new TableHeap(bpm, lock_manager, log_manager, txn);
+    txn_manager->Commit(txn);
+    delete txn;
+
+    LatencyHistogram txn_latency;
+    for (int i = 0; i < num_txns; ++i) {
+      auto start = steady_clock::now();
+      txn = txn_manager->Begin();
+      for (int j = 0; j < tuples_per_txn; ++j) {
+        std::string text = "tuple " + std::to_string(i * tuples_per_txn + j);
+        Tuple tuple({ValueFactory::GetIntegerValue(j), ValueFactory::GetVarcharValue(text)}, &schema);
+        RID rid;
+        ASSERT_TRUE(table->InsertTuple(tuple, &rid, txn));
+      }
+      txn_manager->Commit(txn);
+      bpm->FlushAllPages();
+      txn_latency.Record(steady_clock::now() - start);
+      delete txn;
+    }
+
+    LatencyHistogram query_latency;
+    for (int i = 0; i < num_queries; ++i) {
+      auto *cold_bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+      TableHeap cold_table(cold_bpm, lock_manager, log_manager, table->GetFirstPageId());
+      auto start = steady_clock::now();
+      txn = txn_manager->Begin();
+      int num_tuples = 0;
+      for (auto it = cold_table.Begin(txn); it != cold_table.End(); ++it) {
+        num_tuples++;
+      }
+      txn_manager->Commit(txn);
+      query_latency.Record(steady_clock::now() - start);
+      delete txn;
+      delete cold_bpm;
+      EXPECT_EQ(num_txns * tuples_per_txn, num_tuples);
+    }
+
+    auto txns = txn_latency.GetSnapshot();
+    auto queries = query_latency.GetSnapshot();
+    printf("[BENCHMARK] %s: transaction p50/p99/p999 %lu/%lu/%lu us, query p50/p99/p999 %lu/%lu/%lu us, %lu stalls\n",
+           name.c_str(), txns.GetPercentile(50) / 1000, txns.GetPercentile(99) / 1000, txns.GetPercentile(99.9) / 1000,
+           queries.GetPercentile(50) / 1000, queries.GetPercentile(99) / 1000, queries.GetPercentile(99.9) / 1000,
+           disk_manager->GetNumStalls());
+
+    delete table;
+    delete txn_manager;
+    delete log_manager;
+    delete lock_manager;
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub